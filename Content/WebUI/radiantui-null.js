@@ -2,6 +2,15 @@ var RadiantUI;
 if (!RadiantUI) {
 	RadiantUI = {};
 	RadiantUI.TriggerEvent = function() {}
+	RadiantUI.Call = function() { return Promise.reject(new Error('RadiantUI is not available')); }
 	RadiantUI.SetCallback = function() {}
+	RadiantUI.AddCallback = function() {}
 	RadiantUI.RemoveCallback = function() {}
+	RadiantUI.ReadState = function() { return null; }
+	RadiantUI.BindState = function(name, target) { return target || {}; }
+	RadiantUI.requestAnimationFrame = function(callback) { return window.requestAnimationFrame(callback); }
+	RadiantUI.cancelAnimationFrame = function(id) { window.cancelAnimationFrame(id); }
+	RadiantUI.UseGameClock = function() {}
+	RadiantUI.PerformanceHint = 'full';
+	RadiantUI.onPerformanceHint = function() {}
 }
\ No newline at end of file
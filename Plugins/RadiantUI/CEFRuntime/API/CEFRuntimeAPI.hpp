@@ -21,6 +21,26 @@ class ICefWebViewCallbacks;
 
 #include "CEFJavaScriptAPI.hpp"
 
+#include <chrono>
+
+//! Seconds on a clock shared by the game and the CEF processes (QueryPerformanceCounter on
+//! Windows), so timestamps taken in either can be compared.
+inline double CefRuntimeTimestamp()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! CefRuntimeTimestamp()s a hook message collected between the page and the game.
+struct CefRuntimeHookTiming
+{
+	//! Page to game: TriggerEvent() was entered. Game to page: the page received the message.
+	double PageTime;
+	//! Page to game: the browser process received the message. Game to page: it was sent.
+	double BrowserTime;
+	//! Game to page only: the page's callbacks returned.
+	double PageHandledTime;
+};
+
 struct CefRuntimeRect
 {
 	int X;
@@ -119,17 +139,55 @@ struct CefRuntimeKeyEvent {
 	bool FocusOnEditableField;
 };
 
+//! Process wide settings passed to CreateCefRuntimeAPI, they can't change once it has run.
+struct CefRuntimeSettings
+{
+	//! Absolute directory of the default request context's disk cache, null or empty for an
+	//! in-memory cache.
+	const char* CachePath;
+
+	//! Size limit of each disk cache in MB, 0 lets Chromium choose.
+	int DiskCacheSizeMB;
+
+	//! Stores V8's compiled code next to scripts in the HTTP cache, so later loads of a
+	//! script skip most of its compilation. Only applies to scripts that pass through the
+	//! HTTP cache, content:// is served by the runtime directly and never does.
+	bool V8CodeCache;
+
+	//! Puts every view of a site in one renderer process, so they share V8's in-memory
+	//! compilation cache and identical content:// scripts are compiled once. All the
+	//! views' scripts then run on that one renderer's main thread.
+	bool ProcessPerSite;
+};
+
 class ICefRuntimeAPI
 {
 public:
 	virtual ~ICefRuntimeAPI() {};
 
-	//! Asynchronous call to create a webview.
-	virtual void CreateWebView(const char* InStartupURL, int InSizeX, int InSizeY, bool InTransparentPainting, ICefWebViewCallbacks *InCallbacks) = 0;
+	//! Asynchronous call to create a webview. InRequestContext is a profile added with
+	//! AddRequestContext, null, empty or unknown names use the default request context.
+	virtual void CreateWebView(const char* InStartupURL, int InSizeX, int InSizeY, bool InTransparentPainting, const char* InRequestContext, ICefWebViewCallbacks *InCallbacks) = 0;
+
+	//! Adds a named request context profile. Every view created with it shares one HTTP
+	//! cache, cookie store and local storage, kept apart from other profiles. InCachePath is
+	//! an absolute directory for a disk cache, null or empty for an in-memory one. Returns
+	//! false if the name is already taken.
+	virtual bool AddRequestContext(const char* InName, const char* InCachePath) = 0;
 
 	//! Get the variant factory for creating variants.
 	virtual ICefRuntimeVariantFactory* GetVariantFactory() = 0;
 
+	//! Serves the files in a zip archive as content://<InMountPoint>/<file>, ahead of
+	//! ICefWebViewCallbacks::GetFileStream. InData is the whole archive and can be freed once
+	//! this returns. Archives mounted later override files of earlier ones. Returns the number
+	//! of files mounted, 0 if the archive couldn't be read.
+	virtual int MountContentArchive(const void* InData, int InSize, const char* InMountPoint) = 0;
+
+	//! Sets the MIME type content:// serves for files with the extension InExtension
+	//! (e.g. "glb"), replacing the built in type if there is one.
+	virtual void RegisterMimeType(const char* InExtension, const char* InMimeType) = 0;
+
 	//! Call this when you are done with the runtime API.
 	virtual void Release() = 0;
 };
@@ -165,6 +223,93 @@ public:
 
 };
 
+//! Notified by an ICefDataStream when bytes (or headers) become available after
+//! Read() returned 0 (or HasHeaders() returned false).
+class ICefDataStreamListener
+{
+public:
+	virtual ~ICefDataStreamListener() {}
+
+	//! May be called from any thread.
+	virtual void DataAvailable() = 0;
+};
+
+/*! Response to a game://data/ or game://api/ request, produced by the game in chunks.
+
+	Created by ICefWebViewCallbacks on the CEF IO thread and read from it as the
+	page consumes the response.
+*/
+class ICefDataStream
+{
+public:
+	virtual ~ICefDataStream() {}
+
+	//! When the CefRuntime is done with your stream it will release it with this function.
+	virtual void Release() = 0;
+
+	//! False until the game has decided on the status and MIME type.
+	virtual bool HasHeaders() = 0;
+	virtual int GetStatus() = 0;
+	virtual const char* GetMimeType() = 0;
+
+	//! Cache-Control header for the response, null for no-store.
+	virtual const char* GetCacheControl() = 0;
+
+	//! Copies up to InMaxBytes. Returns the number of bytes copied, 0 if nothing is
+	//! ready yet (the listener is notified when there is) or -1 at the end of the stream.
+	virtual int Read(void* OutBuffer, int InMaxBytes) = 0;
+
+	virtual void SetListener(ICefDataStreamListener* InListener) = 0;
+
+	//! The request was cancelled, e.g. the page navigated away.
+	virtual void Cancel() = 0;
+};
+
+/*! Block of typed fields shared with the page's render process.
+
+	Game code declares fields once and rewrites them as often as it likes;
+	pages read the latest values with RadiantUI.ReadState() (typically from
+	requestAnimationFrame) without any per-update IPC. Must only be used
+	from one thread.
+*/
+class ICefSharedState
+{
+public:
+	virtual ~ICefSharedState() {}
+
+	enum EFieldType
+	{
+		Field_Int,
+		Field_Double,
+		Field_Bool,
+		Field_String
+	};
+
+	//! Declares a field and returns its index, or -1 if the block is full.
+	//! InMaxLength is the UTF-8 capacity of string fields (defaults to 64 bytes).
+	virtual int AddField(const char* InName, EFieldType InType, int InMaxLength = 0) = 0;
+	virtual int FindField(const char* InName) = 0;
+
+	//! Writes between BeginWrite/EndWrite are seen by the page all at once.
+	virtual void BeginWrite() = 0;
+	virtual void SetInt(int InField, int InValue) = 0;
+	virtual void SetDouble(int InField, double InValue) = 0;
+	virtual void SetBool(int InField, bool InValue) = 0;
+	virtual void SetString(int InField, const char* InValue) = 0;
+	virtual void EndWrite() = 0;
+};
+
+//! Receives the result of ICefWebView::ExecuteScript, exactly once. Called on the CEF UI
+//! thread, or from whichever thread destroys the WebView if the page never answered.
+class ICefScriptCallback
+{
+public:
+	virtual ~ICefScriptCallback() {}
+
+	//! InResult is null if the script failed to compile or threw, InError says why.
+	virtual void ScriptCompleted(ICefRuntimeVariant* InResult, const char* InError) = 0;
+};
+
 class ICefWebView
 {
 public:
@@ -177,6 +322,32 @@ public:
 	virtual void LoadURL(const char *InURL) = 0;
 
 	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments) = 0;
+
+	//! Answers a RadiantUI.Call() from ICefWebViewCallbacks::ExecuteJSCall. The promise is
+	//! resolved with InResult (null resolves with null) or rejected if InError is set.
+	virtual void CompleteJSCall(int InCallId, ICefRuntimeVariant* InResult, const char* InError) = 0;
+
+	//! Runs InSource in the main frame and passes its value to InCallback (which may be null).
+	//! A single expression yields its value, a list of statements yields what it returns.
+	virtual void ExecuteScript(const char* InSource, ICefScriptCallback* InCallback) = 0;
+
+	//! Registers a snippet that the page compiles once per script context and keeps, for
+	//! code that is run often. Returns a handle for ExecuteCompiledScript.
+	virtual int CompileScript(const char* InSource) = 0;
+	virtual void ExecuteCompiledScript(int InScript, ICefScriptCallback* InCallback) = 0;
+
+	//! Marks the end of a batch of ExecuteJSHook calls. Once the page has painted a frame
+	//! that includes them, the next Repaint is followed by FenceReached(InSequence).
+	//! Sequence numbers must increase.
+	virtual void InsertFence(int InSequence) = 0;
+
+	//! Stamps hook messages in both directions with CefRuntimeHookTiming. Off by default, it
+	//! costs an extra message per game to page hook.
+	virtual void SetHookTimingEnabled(bool InEnabled) = 0;
+
+	//! Shared state block for this view, created on first use. Owned by the WebView.
+	//! Returns null if the browser hasn't been created yet.
+	virtual ICefSharedState* GetSharedState() = 0;
 		
 	///
 	// Set whether mouse cursor change is disabled.
@@ -335,16 +506,39 @@ public:
 	// Called when regions in the webview are rendered.
 	virtual void Repaint(int InNumRegions, const CefRuntimeRect* InRegions, const void* InBuffer, int InWidth, int InHeight) = 0;
 
+	// Called right after the first Repaint that shows everything sent before
+	// ICefWebView::InsertFence(InSequence), inside the same critical section.
+	virtual void FenceReached(int InSequence) = 0;
+
 	virtual void OnCursorChange(void* InPlatformCursorHandle) = 0;
 
 	// Called when the focused item changes
 	virtual void FocusedNodeChanged(bool InIsEditableField) = 0;
 
-	// Called by JavaScript to execute a hook function in the game
-	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments) = 0;
+	// Called by JavaScript to execute a hook function in the game. InTiming is null unless
+	// hook timing is enabled.
+	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments, const CefRuntimeHookTiming* InTiming) = 0;
+
+	// With hook timing enabled, reports how an ICefWebView::ExecuteJSHook call was delivered.
+	virtual void JSHookDelivered(const char* InHookName, const CefRuntimeHookTiming& InTiming) = 0;
+
+	// Called by RadiantUI.Call(), every call must be answered with ICefWebView::CompleteJSCall
+	virtual void ExecuteJSCall(int InCallId, const char* InName, ICefRuntimeVariantList* InArguments) = 0;
 
 	virtual ICefStream* GetFileStream(const char* FilePath) = 0;
 
+	// Opens game://data/<InChannel>?<InQuery>, returns null if nothing produces the channel.
+	// Called on the CEF IO thread.
+	virtual ICefDataStream* CreateDataStream(const char* InChannel, const char* InQuery) = 0;
+
+	// Handles a game://api/<InPath> request. Never returns null (unknown paths answer 404).
+	// Called on the CEF IO thread.
+	virtual ICefDataStream* CreateApiStream(const char* InMethod, const char* InPath, const char* InQuery, const void* InBody, int InBodySize) = 0;
+
+	// Handles game://texture/<InAssetPath>?<InQuery>, InAssetPath keeps its leading '/'.
+	// Called on the CEF IO thread.
+	virtual ICefDataStream* CreateTextureStream(const char* InAssetPath, const char* InQuery) = 0;
+
 	// Allows the CEF API to make protected calls into game code in an order
 	// that does not cause dead-locks. Game code always does:
 	// LockGameCodeCriticalSection()
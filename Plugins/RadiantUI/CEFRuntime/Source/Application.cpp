@@ -4,12 +4,16 @@
 
 #include "Application.hpp"
 #include "Variants.hpp"
+#include "ResourceHandlers.hpp"
 #include "Assert.hpp"
 
+#include <cctype>
+#include <cstring>
 #include <string>
 
 #include "include/cef_browser.h"
 #include "include/cef_command_line.h"
+#include "include/cef_scheme.h"
 #include "include/wrapper/cef_helpers.h"
 
 
@@ -30,6 +34,8 @@ public:
 
 		if (InName == "TriggerEvent")
 		{
+			const double EntryTime = CefRuntimeTimestamp();
+
 			// dispatch hook to the browser process for execution on the game thread
 			if ((InArguments.size() == 1) && InArguments[0]->IsArray())
 			{
@@ -42,7 +48,8 @@ public:
 					CefString HookName = ArgumentArray->GetValue(0)->GetStringValue();
 					if (!HookName.empty())
 					{
-						CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(HookName);
+						const bool Timed = App->IsHookTimingEnabled(Browser);
+						CefRefPtr<CefProcessMessage> Message = Timed ? CefProcessMessage::Create(std::string(RADUIIPCMSG_TIMEDPREFIX) + HookName.ToString()) : CefProcessMessage::Create(HookName);
 
 						// translate remaining args.
 						if ((ArgumentArray->GetArrayLength() > 1) && ArgumentArray->GetValue(1)->IsArray())
@@ -59,31 +66,80 @@ public:
 							}
 						}
 
+						if (Timed)
+						{
+							CefRefPtr<CefListValue> OutParameters = Message->GetArgumentList();
+							OutParameters->SetDouble(OutParameters->GetSize(), EntryTime);
+						}
+
 						Browser->SendProcessMessage(PID_BROWSER, Message);
 						Handled = true;
 					}
 				}
 			}
 		}
-		else if (InName == "SetHook")
+		else if ((InName == "SetHook") || (InName == "AddHook"))
 		{
 			if ((InArguments.size() == 2) && (InArguments[0]->IsString()) && (InArguments[1]->IsFunction()))
 			{
-				CefString HookName = InArguments[0]->GetStringValue().ToString();
 				CefRefPtr<CefV8Context> Context = CefV8Context::GetCurrentContext();
-				App->SetJSHook(HookName, Context->GetBrowser()->GetIdentifier(), Context, InArguments[1]);
+				if (InName == "SetHook")
+				{
+					App->SetJSHook(InArguments[0]->GetStringValue(), Context, InArguments[1]);
+				}
+				else
+				{
+					App->AddJSHook(InArguments[0]->GetStringValue(), Context, InArguments[1]);
+				}
 				Handled = true;
 			}
 		}
-		else if (InName == "RemoveHook")
+		else if (InName == "MakeBlob")
 		{
 			if ((InArguments.size() == 1) && InArguments[0]->IsString())
 			{
-				CefRefPtr<CefV8Context> Context = CefV8Context::GetCurrentContext();
-				App->RemoveJSHook(InArguments[0]->GetStringValue(), Context->GetBrowser()->GetIdentifier());
+				OutRetval = CreateV8Blob_RenderThread(InArguments[0]->GetStringValue());
+				Handled = true;
+			}
+		}
+		else if (InName == "RemoveHook")
+		{
+			if ((InArguments.size() >= 1) && InArguments[0]->IsString())
+			{
+				CefRefPtr<CefV8Value> Function;
+				if ((InArguments.size() > 1) && InArguments[1]->IsFunction())
+				{
+					Function = InArguments[1];
+				}
+
+				App->RemoveJSHook(InArguments[0]->GetStringValue(), CefV8Context::GetCurrentContext(), Function);
+				Handled = true;
+			}
+		}
+		else if (InName == "Call")
+		{
+			if ((InArguments.size() == 4) && InArguments[0]->IsString() && InArguments[1]->IsArray() && InArguments[2]->IsFunction() && InArguments[3]->IsFunction())
+			{
+				App->BeginJSCall(InArguments[0]->GetStringValue(), InArguments[1], CefV8Context::GetCurrentContext(), InArguments[2], InArguments[3]);
+				Handled = true;
+			}
+		}
+		else if (InName == "FenceReached")
+		{
+			if ((InArguments.size() == 1) && InArguments[0]->IsInt())
+			{
+				CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_FENCEACK);
+				Message->GetArgumentList()->SetInt(0, InArguments[0]->GetIntValue());
+				CefV8Context::GetCurrentContext()->GetBrowser()->SendProcessMessage(PID_BROWSER, Message);
 				Handled = true;
 			}
 		}
+		else if (InName == "ReadState")
+		{
+			CefRefPtr<CefV8Value> Target = (InArguments.size() > 0) ? InArguments[0] : nullptr;
+			OutRetval = App->ReadSharedState(CefV8Context::GetCurrentContext(), Target);
+			Handled = true;
+		}
 		else
 		{
 			ValidAPI = false;
@@ -102,27 +158,381 @@ private:
 	CefRefPtr<Application> App;
 };
 
-void Application::SetJSHook(
-	const CefString& InHookName,
-	int InBrowserID,
-	CefRefPtr<CefV8Context> InContext,
-	CefRefPtr<CefV8Value> InFunction
-	)
+size_t Application::CefStringHash::operator()(const CefString& InString) const
+{
+	// FNV-1a over the UTF-16 code units.
+	const CefString::char_type* Chars = InString.c_str();
+	const size_t Length = InString.length();
+
+	size_t Hash = 2166136261u;
+	for (size_t i = 0; i < Length; ++i)
+	{
+		Hash = (Hash ^ (size_t)Chars[i]) * 16777619u;
+	}
+
+	return Hash;
+}
+
+int Application::InternHookName(const CefString& InHookName)
+{
+	HookNameMap::iterator it = HookNames.find(InHookName);
+	if (it != HookNames.end())
+	{
+		return it->second;
+	}
+
+	const int HookId = (int)HookNames.size();
+	HookNames.insert(HookNameMap::value_type(InHookName, HookId));
+	return HookId;
+}
+
+int Application::FindHookName(const CefString& InHookName)
+{
+	HookNameMap::iterator it = HookNames.find(InHookName);
+	return (it != HookNames.end()) ? it->second : -1;
+}
+
+Application::JSFrameHooks* Application::FindFrameHooks(CefRefPtr<CefV8Context> InContext, bool InCreate)
+{
+	const int BrowserId = InContext->GetBrowser()->GetIdentifier();
+	const int64 FrameId = InContext->GetFrame()->GetIdentifier();
+
+	if (InCreate)
+	{
+		JSFrameHooks& FrameHooks = Hooks[BrowserId][FrameId];
+		if (!FrameHooks.Context.get() || !FrameHooks.Context->IsSame(InContext))
+		{
+			// frame navigated to a new context, hooks from the old one are stale.
+			FrameHooks.Context = InContext;
+			FrameHooks.Hooks.clear();
+		}
+
+		return &FrameHooks;
+	}
+
+	JSBrowserHookMap::iterator BrowserIt = Hooks.find(BrowserId);
+	if (BrowserIt == Hooks.end())
+	{
+		return nullptr;
+	}
+
+	JSFrameHookMap::iterator FrameIt = BrowserIt->second.find(FrameId);
+	if ((FrameIt == BrowserIt->second.end()) || !FrameIt->second.Context->IsSame(InContext))
+	{
+		return nullptr;
+	}
+
+	return &FrameIt->second;
+}
+
+void Application::SetJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction)
+{
+	REQUIRE_RENDER_THREAD()
+
+	JSHookList& HookList = FindFrameHooks(InContext, true)->Hooks[InternHookName(InHookName)];
+	HookList.clear();
+	HookList.push_back(InFunction);
+}
+
+void Application::AddJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction)
+{
+	REQUIRE_RENDER_THREAD()
+
+	JSHookList& HookList = FindFrameHooks(InContext, true)->Hooks[InternHookName(InHookName)];
+	for (JSHookList::iterator it = HookList.begin(); it != HookList.end(); ++it)
+	{
+		if ((*it)->IsSame(InFunction))
+		{
+			return;
+		}
+	}
+
+	HookList.push_back(InFunction);
+}
+
+void Application::RemoveJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction)
+{
+	REQUIRE_RENDER_THREAD()
+
+	const int HookId = FindHookName(InHookName);
+	JSFrameHooks* FrameHooks = (HookId >= 0) ? FindFrameHooks(InContext, false) : nullptr;
+	if (!FrameHooks)
+	{
+		return;
+	}
+
+	std::unordered_map<int, JSHookList>::iterator HookIt = FrameHooks->Hooks.find(HookId);
+	if (HookIt == FrameHooks->Hooks.end())
+	{
+		return;
+	}
+
+	if (InFunction.get())
+	{
+		JSHookList& HookList = HookIt->second;
+		for (JSHookList::iterator it = HookList.begin(); it != HookList.end(); ++it)
+		{
+			if ((*it)->IsSame(InFunction))
+			{
+				HookList.erase(it);
+				break;
+			}
+		}
+
+		if (HookList.empty())
+		{
+			FrameHooks->Hooks.erase(HookIt);
+		}
+	}
+	else
+	{
+		FrameHooks->Hooks.erase(HookIt);
+	}
+}
+
+CefRefPtr<CefV8Value> Application::ReadSharedState(CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InTarget)
+{
+	REQUIRE_RENDER_THREAD()
+
+	const int BrowserId = InContext->GetBrowser()->GetIdentifier();
+
+	// the game creates the block on first use and says so, so a failed open isn't
+	// retried on every read until then.
+	if (MissingSharedStates.count(BrowserId) > 0)
+	{
+		return CefV8Value::CreateNull();
+	}
+
+	CefRefPtr<SharedStateReader>& Reader = SharedStates[BrowserId];
+	if (!Reader.get())
+	{
+		CefRefPtr<SharedStateReader> NewReader = new SharedStateReader();
+		if (!NewReader->Open(BrowserId))
+		{
+			SharedStates.erase(BrowserId);
+			MissingSharedStates.insert(BrowserId);
+			return CefV8Value::CreateNull();
+		}
+
+		Reader = NewReader;
+	}
+
+	return Reader->Read_RenderThread(InTarget);
+}
+
+void Application::BeginJSCall(const CefString& InName, CefRefPtr<CefV8Value> InArguments, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InResolve, CefRefPtr<CefV8Value> InReject)
+{
+	REQUIRE_V8_CONTEXT()
+
+	CefRefPtr<CefBrowser> Browser = InContext->GetBrowser();
+
+	const int CallId = ++NextCallId;
+
+	JSPendingCall& Call = PendingCalls[Browser->GetIdentifier()][CallId];
+	Call.Context = InContext;
+	Call.Resolve = InResolve;
+	Call.Reject = InReject;
+
+	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_CALL);
+	CefRefPtr<CefListValue> MessageArguments = Message->GetArgumentList();
+	MessageArguments->SetInt(0, CallId);
+	MessageArguments->SetString(1, InName);
+	MessageArguments->SetList(2, V8ArrayToList_RenderThread(InArguments));
+
+	Browser->SendProcessMessage(PID_BROWSER, Message);
+}
+
+bool Application::CompleteJSCall(CefRefPtr<CefBrowser> InBrowser, CefRefPtr<CefListValue> InResult)
+{
+	REQUIRE_RENDER_THREAD()
+
+	std::unordered_map<int, JSPendingCallMap>::iterator BrowserIt = PendingCalls.find(InBrowser->GetIdentifier());
+	if (BrowserIt == PendingCalls.end())
+	{
+		return false;
+	}
+
+	// the page may have navigated away since the call was made.
+	JSPendingCallMap::iterator CallIt = BrowserIt->second.find(InResult->GetInt(0));
+	if (CallIt == BrowserIt->second.end())
+	{
+		return false;
+	}
+
+	JSPendingCall Call = CallIt->second;
+	BrowserIt->second.erase(CallIt);
+
+	Call.Context->Enter();
+
+	CefV8ValueList Arguments;
+	Arguments.push_back(ValueToV8Value_RenderThread(InResult->GetValue(2)));
+
+	if (InResult->GetBool(1))
+	{
+		Call.Resolve->ExecuteFunction(nullptr, Arguments);
+	}
+	else
+	{
+		Call.Reject->ExecuteFunction(nullptr, Arguments);
+	}
+
+	Call.Context->Exit();
+
+	return true;
+}
+
+namespace
+{
+	// Wraps InSource in a function, as an expression if it is one so its value is returned.
+	CefRefPtr<CefV8Value> CompileScript_RenderThread(CefRefPtr<CefV8Context> InContext, const std::string& InSource, CefString& OutError)
+	{
+		std::string Expression = InSource;
+		while (!Expression.empty() && (isspace((unsigned char)Expression.back()) || (Expression.back() == ';')))
+		{
+			Expression.pop_back();
+		}
+
+		CefRefPtr<CefV8Value> Function;
+		CefRefPtr<CefV8Exception> Exception;
+
+		if (InContext->Eval("(function() { return (\n" + Expression + "\n); })", Function, Exception) && Function.get())
+		{
+			return Function;
+		}
+
+		if (InContext->Eval("(function() {\n" + InSource + "\n})", Function, Exception) && Function.get())
+		{
+			return Function;
+		}
+
+		OutError = Exception.get() ? Exception->GetMessage() : CefString("failed to compile script");
+		return nullptr;
+	}
+}
+
+bool Application::ExecuteScript(CefRefPtr<CefBrowser> InBrowser, CefRefPtr<CefListValue> InRequest)
 {
 	REQUIRE_RENDER_THREAD()
 
-	JSHook Hook;
-	Hook.Context = InContext;
-	Hook.Function = InFunction;
+	const int RequestId = InRequest->GetInt(0);
+	const int ScriptId = InRequest->GetInt(1);
+
+	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_EXECUTERESULT);
+	CefRefPtr<CefListValue> Result = Message->GetArgumentList();
+	Result->SetInt(0, RequestId);
 
-	Hooks.insert(JSHookMap::value_type(std::make_pair(InHookName.ToString(), InBrowserID), Hook));
+	CefRefPtr<CefV8Context> Context = InBrowser->GetMainFrame()->GetV8Context();
+	CefString Error;
+
+	if (Context.get() && Context->Enter())
+	{
+		CefRefPtr<CefV8Value> Function;
+
+		if (ScriptId > 0)
+		{
+			JSScriptCache& Cache = ScriptCaches[InBrowser->GetIdentifier()];
+			if (!Cache.Context.get() || !Cache.Context->IsSame(Context))
+			{
+				Cache.Context = Context;
+				Cache.Functions.clear();
+			}
+
+			CefRefPtr<CefV8Value>& Cached = Cache.Functions[ScriptId];
+			if (!Cached.get())
+			{
+				Cached = CompileScript_RenderThread(Context, InRequest->GetString(2).ToString(), Error);
+			}
+
+			Function = Cached;
+			if (!Function.get())
+			{
+				// try again next time, the page may define what the script needs by then.
+				Cache.Functions.erase(ScriptId);
+			}
+		}
+		else
+		{
+			Function = CompileScript_RenderThread(Context, InRequest->GetString(2).ToString(), Error);
+		}
+
+		if (Function.get())
+		{
+			CefRefPtr<CefV8Value> Value = Function->ExecuteFunction(nullptr, CefV8ValueList());
+			if (Value.get())
+			{
+				Result->SetBool(1, true);
+				Result->SetValue(2, V8ValueToValue_RenderThread(Value));
+			}
+			else
+			{
+				Error = Function->HasException() ? Function->GetException()->GetMessage() : CefString("script failed");
+				Function->ClearException();
+			}
+		}
+
+		Context->Exit();
+	}
+	else
+	{
+		Error = "the page has no script context";
+	}
+
+	if (!Error.empty())
+	{
+		Result->SetBool(1, false);
+		Result->SetString(2, Error);
+	}
+
+	// fire and forget requests don't want an answer.
+	if (RequestId)
+	{
+		InBrowser->SendProcessMessage(PID_BROWSER, Message);
+	}
+
+	return true;
 }
 
-void Application::RemoveJSHook(const CefString& InHookName, int InBrowserId)
+bool Application::InsertFence(CefRefPtr<CefBrowser> InBrowser, int InSequence)
 {
 	REQUIRE_RENDER_THREAD()
 
-		Hooks.erase(std::make_pair(InHookName.ToString(), InBrowserId));
+	CefRefPtr<CefV8Context> Context = InBrowser->GetMainFrame()->GetV8Context();
+	if (!Context.get() || !Context->Enter())
+	{
+		return false;
+	}
+
+	// the page answers from its second animation frame, by then the first one (which has
+	// everything sent before the fence) has been committed.
+	CefRefPtr<CefV8Value> RadiantUI = Context->GetGlobal()->GetValue("RadiantUI");
+	CefRefPtr<CefV8Value> Fence = (RadiantUI.get() && RadiantUI->IsObject()) ? RadiantUI->GetValue("__Fence") : nullptr;
+	if (Fence.get() && Fence->IsFunction())
+	{
+		CefV8ValueList Arguments;
+		Arguments.push_back(CefV8Value::CreateInt(InSequence));
+		Fence->ExecuteFunction(nullptr, Arguments);
+	}
+
+	Context->Exit();
+	return true;
+}
+
+void Application::OnRegisterCustomSchemes(CefRefPtr<CefSchemeRegistrar> registrar)
+{
+	// standard so game:// URLs resolve relative paths and have an origin.
+	registrar->AddCustomScheme(RADUI_GAME_SCHEME, true, false, false);
+}
+
+void Application::OnBeforeChildProcessLaunch(CefRefPtr<CefCommandLine> command_line)
+{
+	command_line->AppendSwitchWithValue(RADUI_SWITCH_HOSTPROCESS, std::to_string((unsigned long long)GetCurrentProcessId()));
+
+	if (V8CodeCache && (command_line->GetSwitchValue("type") == "renderer"))
+	{
+		// renderers compile the script and hand the code cache back to be stored with the
+		// script's HTTP cache entry, it is dropped whenever that entry is replaced.
+		command_line->AppendSwitchWithValue("v8-cache-options", "code");
+	}
 }
 
 // CefRenderProcessHandler methods.
@@ -134,37 +544,258 @@ void Application::OnWebKitInitialized()
 		"if (!RadiantUI)"
 		"  RadiantUI = {};"
 		"(function() {"
+		"  native function MakeBlob();"
+		"  var ChunkSize = 8192;"
+		"  function PackValue(value) {"
+		"    if ((typeof value !== 'object') || (value === null)) {"
+		"      return value;"
+		"    }"
+		"    var bytes;"
+		"    if (value instanceof ArrayBuffer) {"
+		"      bytes = new Uint8Array(value);"
+		"    } else if (ArrayBuffer.isView(value)) {"
+		"      bytes = new Uint8Array(value.buffer, value.byteOffset, value.byteLength);"
+		"    } else if (Array.isArray(value)) {"
+		"      var packed = value;"
+		"      for (var i = 0; i < value.length; ++i) {"
+		"        var item = PackValue(value[i]);"
+		"        if (item !== value[i]) {"
+		"          if (packed === value) {"
+		"            packed = value.slice();"
+		"          }"
+		"          packed[i] = item;"
+		"        }"
+		"      }"
+		"      return packed;"
+		"    } else {"
+		"      var packedObject = value;"
+		"      for (var key in value) {"
+		"        if (value.hasOwnProperty(key)) {"
+		"          var field = PackValue(value[key]);"
+		"          if (field !== value[key]) {"
+		"            if (packedObject === value) {"
+		"              packedObject = {};"
+		"              for (var copyKey in value) {"
+		"                if (value.hasOwnProperty(copyKey)) {"
+		"                  packedObject[copyKey] = value[copyKey];"
+		"                }"
+		"              }"
+		"            }"
+		"            packedObject[key] = field;"
+		"          }"
+		"        }"
+		"      }"
+		"      return packedObject;"
+		"    }"
+		"    var byteString = '';"
+		"    for (var offset = 0; offset < bytes.length; offset += ChunkSize) {"
+		"      byteString += String.fromCharCode.apply(null, bytes.subarray(offset, offset + ChunkSize));"
+		"    }"
+		"    return MakeBlob(byteString);"
+		"  }"
+		"  RadiantUI.__MakeArrayBuffer = function(byteString) {"
+		"    var bytes = new Uint8Array(byteString.length);"
+		"    for (var i = 0; i < byteString.length; ++i) {"
+		"      bytes[i] = byteString.charCodeAt(i);"
+		"    }"
+		"    return bytes.buffer;"
+		"  };"
 		"  RadiantUI.TriggerEvent = function() {"
 		"    native function TriggerEvent();"
-		"    return TriggerEvent(Array.prototype.slice.call(arguments));"
+		"    var args = Array.prototype.slice.call(arguments);"
+		"    if (args.length > 1) {"
+		"      args[1] = PackValue(args[1]);"
+		"    }"
+		"    return TriggerEvent(args);"
 		"  };"
 		"  RadiantUI.SetCallback = function(name, callback) {"
 		"    native function SetHook();"
 		"    return SetHook(name, callback);"
 		"  };"
-		"  RadiantUI.RemoveCallback = function(name) {"
+		"  RadiantUI.Call = function(name, args) {"
+		"    native function Call();"
+		"    return new Promise(function(resolve, reject) {"
+		"      Call(name, PackValue(args || []), resolve, function(message) {"
+		"        reject(new Error(message));"
+		"      });"
+		"    });"
+		"  };"
+		"  RadiantUI.ReadState = function(target) {"
+		"    native function ReadState();"
+		"    return ReadState(target);"
+		"  };"
+		"  RadiantUI.AddCallback = function(name, callback) {"
+		"    native function AddHook();"
+		"    return AddHook(name, callback);"
+		"  };"
+		"  RadiantUI.RemoveCallback = function(name, callback) {"
 		"    native function RemoveHook();"
-		"    return RemoveHook(name);"
+		"    return (callback === undefined) ? RemoveHook(name) : RemoveHook(name, callback);"
+		"  };"
+		"  var stateBindings = {};"
+		"  function FindStateBinding(name, target) {"
+		"    var bindings = stateBindings[name] || [];"
+		"    for (var i = 0; i < bindings.length; ++i) {"
+		"      if (bindings[i].target === target) {"
+		"        return i;"
+		"      }"
+		"    }"
+		"    return -1;"
+		"  }"
+		"  RadiantUI.UnbindState = function(name, target) {"
+		"    var index = FindStateBinding(name, target);"
+		"    if (index >= 0) {"
+		"      RadiantUI.RemoveCallback(name, stateBindings[name][index].callback);"
+		"      stateBindings[name].splice(index, 1);"
+		"    }"
+		"  };"
+		"  RadiantUI.BindState = function(name, target, onChange) {"
+		"    target = target || {};"
+		"    RadiantUI.UnbindState(name, target);"
+		"    var callback = function(patch) {"
+		"      for (var key in patch) {"
+		"        target[key] = patch[key];"
+		"      }"
+		"      if (onChange) {"
+		"        onChange(target, patch);"
+		"      }"
+		"    };"
+		"    (stateBindings[name] = stateBindings[name] || []).push({ target: target, callback: callback });"
+		"    RadiantUI.AddCallback(name, callback);"
+		"    RadiantUI.TriggerEvent('RadiantUI.BindState', [name]);"
+		"    return target;"
+		"  };"
+		"  var frameCallbacks = [];"
+		"  var nextFrameId = 0;"
+		"  var frameHooked = false;"
+		"  RadiantUI.FrameNumber = 0;"
+		"  RadiantUI.GameTime = 0;"
+		"  RadiantUI.GameDeltaTime = 0;"
+		"  function RunFrame(timestamp, delta, worldTime, worldDelta, frame) {"
+		"    RadiantUI.FrameNumber = frame;"
+		"    RadiantUI.GameTime = worldTime;"
+		"    RadiantUI.GameDeltaTime = worldDelta;"
+		"    var callbacks = frameCallbacks;"
+		"    frameCallbacks = [];"
+		"    for (var i = 0; i < callbacks.length; ++i) {"
+		"      if (callbacks[i].callback) {"
+		"        try {"
+		"          callbacks[i].callback(timestamp);"
+		"        } catch (e) {"
+		"          setTimeout(function() { throw e; }, 0);"
+		"        }"
+		"      }"
+		"    }"
+		"  }"
+		"  RadiantUI.requestAnimationFrame = function(callback) {"
+		"    if (!frameHooked) {"
+		"      frameHooked = true;"
+		"      RadiantUI.AddCallback('RadiantUI.Frame', RunFrame);"
+		"    }"
+		"    frameCallbacks.push({ id: ++nextFrameId, callback: callback });"
+		"    return nextFrameId;"
+		"  };"
+		"  RadiantUI.cancelAnimationFrame = function(id) {"
+		"    for (var i = 0; i < frameCallbacks.length; ++i) {"
+		"      if (frameCallbacks[i].id === id) {"
+		"        frameCallbacks[i].callback = null;"
+		"      }"
+		"    }"
+		"  };"
+		"  RadiantUI.PerformanceHint = 'full';"
+		"  var hintCallbacks = null;"
+		"  function SetPerformanceHint(level) {"
+		"    var root = document.documentElement;"
+		"    if (root) {"
+		"      root.classList.remove('radiantui-perf-' + RadiantUI.PerformanceHint);"
+		"      root.classList.add('radiantui-perf-' + level);"
+		"    }"
+		"    if (level === RadiantUI.PerformanceHint) {"
+		"      return;"
+		"    }"
+		"    RadiantUI.PerformanceHint = level;"
+		"    for (var i = 0; i < hintCallbacks.length; ++i) {"
+		"      hintCallbacks[i](level);"
+		"    }"
+		"  }"
+		"  RadiantUI.onPerformanceHint = function(callback) {"
+		"    if (!hintCallbacks) {"
+		"      hintCallbacks = [];"
+		"      RadiantUI.AddCallback('RadiantUI.PerformanceHint', SetPerformanceHint);"
+		"      RadiantUI.Call('RadiantUI.GetPerformanceHint').then(SetPerformanceHint, function() {});"
+		"    }"
+		"    if (callback) {"
+		"      hintCallbacks.push(callback);"
+		"    }"
+		"  };"
+		"  var nativeRequestAnimationFrame = window.requestAnimationFrame;"
+		"  RadiantUI.__Fence = function(sequence) {"
+		"    native function FenceReached();"
+		"    nativeRequestAnimationFrame.call(window, function() {"
+		"      nativeRequestAnimationFrame.call(window, function() {"
+		"        FenceReached(sequence);"
+		"      });"
+		"    });"
+		"  };"
+		"  RadiantUI.UseGameClock = function() {"
+		"    window.requestAnimationFrame = window.webkitRequestAnimationFrame = RadiantUI.requestAnimationFrame;"
+		"    window.cancelAnimationFrame = window.webkitCancelAnimationFrame = RadiantUI.cancelAnimationFrame;"
 		"  };"
 		"})();";
 	CefRegisterExtension("RadiantUI JSHooks Extension", script, new JSHookExtensionHandler(this));
 }
 
+void Application::OnBrowserDestroyed(CefRefPtr<CefBrowser> browser)
+{
+	Hooks.erase(browser->GetIdentifier());
+	SharedStates.erase(browser->GetIdentifier());
+	MissingSharedStates.erase(browser->GetIdentifier());
+	PendingCalls.erase(browser->GetIdentifier());
+	ScriptCaches.erase(browser->GetIdentifier());
+	TimedBrowsers.erase(browser->GetIdentifier());
+}
+
 void Application::OnContextReleased(CefRefPtr<CefBrowser> browser,
 	CefRefPtr<CefFrame> frame,
 	CefRefPtr<CefV8Context> context)
 {
-	for (JSHookMap::iterator it = Hooks.begin(); it != Hooks.end();)
+	std::unordered_map<int, JSPendingCallMap>::iterator CallsIt = PendingCalls.find(browser->GetIdentifier());
+	if (CallsIt != PendingCalls.end())
 	{
-		if (it->second.Context->IsSame(context))
+		// answers for a released context are dropped along with their promises.
+		for (JSPendingCallMap::iterator it = CallsIt->second.begin(); it != CallsIt->second.end();)
 		{
-			JSHookMap::iterator next = it; ++next;
-			Hooks.erase(it);
-			it = next;
+			if (it->second.Context->IsSame(context))
+			{
+				it = CallsIt->second.erase(it);
+			}
+			else
+			{
+				++it;
+			}
 		}
-		else
+	}
+
+	std::unordered_map<int, JSScriptCache>::iterator ScriptsIt = ScriptCaches.find(browser->GetIdentifier());
+	if ((ScriptsIt != ScriptCaches.end()) && ScriptsIt->second.Context->IsSame(context))
+	{
+		ScriptCaches.erase(ScriptsIt);
+	}
+
+	JSBrowserHookMap::iterator BrowserIt = Hooks.find(browser->GetIdentifier());
+	if (BrowserIt == Hooks.end())
+	{
+		return;
+	}
+
+	JSFrameHookMap::iterator FrameIt = BrowserIt->second.find(frame->GetIdentifier());
+	if ((FrameIt != BrowserIt->second.end()) && FrameIt->second.Context->IsSame(context))
+	{
+		BrowserIt->second.erase(FrameIt);
+
+		if (BrowserIt->second.empty())
 		{
-			++it;
+			Hooks.erase(BrowserIt);
 		}
 	}
 }
@@ -188,35 +819,113 @@ bool Application::OnProcessMessageReceived(
 {
 	ASSERT(InSourceProcess == PID_BROWSER); // call should have come from browser process.
 
-	if (!Hooks.empty())
+	if (InMessage->GetName() == RADUIIPCMSG_CALLRESULT)
+	{
+		return CompleteJSCall(InBrowser, InMessage->GetArgumentList());
+	}
+	else if (InMessage->GetName() == RADUIIPCMSG_HOOKTIMING)
 	{
-		CefString MessageName = InMessage->GetName();
-		JSHookMap::iterator it = Hooks.find(std::make_pair(MessageName, InBrowser->GetIdentifier()));
-		if (it != Hooks.end())
+		if (InMessage->GetArgumentList()->GetBool(0))
 		{
-			// invoke JS callback
-			JSHook Hook(it->second);
+			TimedBrowsers.insert(InBrowser->GetIdentifier());
+		}
+		else
+		{
+			TimedBrowsers.erase(InBrowser->GetIdentifier());
+		}
+		return true;
+	}
+	else if (InMessage->GetName() == RADUIIPCMSG_FENCE)
+	{
+		return InsertFence(InBrowser, InMessage->GetArgumentList()->GetInt(0));
+	}
+	else if (InMessage->GetName() == RADUIIPCMSG_EXECUTE)
+	{
+		return ExecuteScript(InBrowser, InMessage->GetArgumentList());
+	}
+	else if (InMessage->GetName() == RADUIIPCMSG_SHAREDSTATE)
+	{
+		MissingSharedStates.erase(InBrowser->GetIdentifier());
+		return true;
+	}
 
-			Hook.Context->Enter();
+	CefString HookName = InMessage->GetName();
+	CefRefPtr<CefListValue> MessageArguments = InMessage->GetArgumentList();
+	int NumMessageArguments = (int)MessageArguments->GetSize();
 
-			CefRefPtr<CefListValue> MessageArguments = InMessage->GetArgumentList();
-			const int NumMessageArguments = (int)MessageArguments->GetSize();
+	CefRuntimeHookTiming Timing;
+	bool Timed = false;
 
-			// convert message arguments
-			CefV8ValueList Arguments;
+	// HOOKTIMING arrives ahead of the first timed hook, untimed browsers skip the prefix check.
+	if (IsHookTimingEnabled(InBrowser) && HasTimedPrefix(HookName) && (NumMessageArguments > 0))
+	{
+		// the browser's send time is the last argument.
+		Timing.PageTime = CefRuntimeTimestamp();
+		Timing.BrowserTime = MessageArguments->GetDouble(--NumMessageArguments);
+		HookName = HookName.ToString().substr(strlen(RADUIIPCMSG_TIMEDPREFIX));
+		Timed = true;
+	}
 
-			for (int i = 0; i < NumMessageArguments; ++i)
-			{
-				Arguments.push_back(ListItemToV8Value_RenderThread(MessageArguments, i));
-			}
+	JSBrowserHookMap::iterator BrowserIt = Hooks.find(InBrowser->GetIdentifier());
+	if (BrowserIt == Hooks.end())
+	{
+		return false;
+	}
+
+	const int HookId = FindHookName(HookName);
+	if (HookId < 0)
+	{
+		return false;
+	}
+
+	// collect subscribers first, callbacks are free to add or remove hooks.
+	std::vector<std::pair<CefRefPtr<CefV8Context>, JSHookList> > Targets;
 
-			Hook.Function->ExecuteFunction(nullptr, Arguments);
-			Hook.Context->Exit();
-			return true;
+	for (JSFrameHookMap::iterator FrameIt = BrowserIt->second.begin(); FrameIt != BrowserIt->second.end(); ++FrameIt)
+	{
+		std::unordered_map<int, JSHookList>::iterator HookIt = FrameIt->second.Hooks.find(HookId);
+		if (HookIt != FrameIt->second.Hooks.end())
+		{
+			Targets.push_back(std::make_pair(FrameIt->second.Context, HookIt->second));
 		}
 	}
 
-	return false;
+	for (size_t TargetIndex = 0; TargetIndex < Targets.size(); ++TargetIndex)
+	{
+		CefRefPtr<CefV8Context> Context = Targets[TargetIndex].first;
+		const JSHookList& HookList = Targets[TargetIndex].second;
+
+		// invoke JS callbacks
+		Context->Enter();
+
+		// convert message arguments
+		CefV8ValueList Arguments;
+
+		for (int i = 0; i < NumMessageArguments; ++i)
+		{
+			Arguments.push_back(ListItemToV8Value_RenderThread(MessageArguments, i));
+		}
+
+		for (JSHookList::const_iterator it = HookList.begin(); it != HookList.end(); ++it)
+		{
+			(*it)->ExecuteFunction(nullptr, Arguments);
+		}
+
+		Context->Exit();
+	}
+
+	if (Timed)
+	{
+		CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_HOOKTIMING);
+		CefRefPtr<CefListValue> Result = Message->GetArgumentList();
+		Result->SetString(0, HookName);
+		Result->SetDouble(1, Timing.BrowserTime);
+		Result->SetDouble(2, Timing.PageTime);
+		Result->SetDouble(3, CefRuntimeTimestamp());
+		InBrowser->SendProcessMessage(PID_BROWSER, Message);
+	}
+
+	return !Targets.empty();
 }
 
 void Application::OnBeforeCommandLineProcessing(
@@ -238,6 +947,17 @@ void Application::OnBeforeCommandLineProcessing(
 	command_line->AppendSwitch("disable-gpu");
 	command_line->AppendSwitch("disable-gpu-compositing");
 	command_line->AppendSwitch("enable-begin-frame-scheduling");
+
+	if (process_type.empty() && (DiskCacheSizeMB > 0))
+	{
+		command_line->AppendSwitchWithValue("disk-cache-size", std::to_string((int64)DiskCacheSizeMB * 1024 * 1024));
+	}
+
+	if (process_type.empty() && ProcessPerSite)
+	{
+		// one renderer for every http://content view, V8's compilation cache is per process.
+		command_line->AppendSwitch("process-per-site");
+	}
 };
 
 
@@ -5,8 +5,53 @@
 #pragma once
 
 #include "include/cef_app.h"
+#include "SharedState.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define RADUIIPCMSG_FOCUSNODECHANGED "RADUIIPC.EditModeChanged"
+// [call id, name, arguments] renderer -> browser
+#define RADUIIPCMSG_CALL "RADUIIPC.Call"
+// [call id, succeeded, result or error message] browser -> renderer
+#define RADUIIPCMSG_CALLRESULT "RADUIIPC.CallResult"
+// [request id, script handle or 0, source] browser -> renderer
+#define RADUIIPCMSG_EXECUTE "RADUIIPC.Execute"
+// [request id, succeeded, result or error message] renderer -> browser
+#define RADUIIPCMSG_EXECUTERESULT "RADUIIPC.ExecuteResult"
+// [sequence] browser -> renderer, answered with FENCEACK once a frame after it has painted
+#define RADUIIPCMSG_FENCE "RADUIIPC.Fence"
+#define RADUIIPCMSG_FENCEACK "RADUIIPC.FenceAck"
+// [enabled] browser -> renderer,
+// [hook name, browser send time, page receive time, page handled time] renderer -> browser
+#define RADUIIPCMSG_HOOKTIMING "RADUIIPC.HookTiming"
+// hook messages carrying their send time as an extra last argument
+#define RADUIIPCMSG_TIMEDPREFIX "RADUIIPC.Timed:"
+// [] browser -> renderer, the game has created the browser's shared state block
+#define RADUIIPCMSG_SHAREDSTATE "RADUIIPC.SharedState"
+
+// compares in place, hook names are checked on every message.
+inline bool HasTimedPrefix(const CefString& InName)
+{
+	static const char Prefix[] = RADUIIPCMSG_TIMEDPREFIX;
+	const size_t PrefixLength = sizeof(Prefix) - 1;
+	if (InName.length() < PrefixLength)
+	{
+		return false;
+	}
+
+	const CefString::char_type* Name = InName.c_str();
+	for (size_t i = 0; i < PrefixLength; ++i)
+	{
+		if (Name[i] != (CefString::char_type)Prefix[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
 
 // Implement application-level callbacks for the browser process.
 class Application : public CefApp,
@@ -16,34 +61,111 @@ class Application : public CefApp,
 	private:
 		IMPLEMENT_REFCOUNTING(Application);
 
-		struct JSHook
+		struct CefStringHash
+		{
+			size_t operator()(const CefString& InString) const;
+		};
+
+		typedef std::vector<CefRefPtr<CefV8Value> > JSHookList;
+
+		// Hooks registered by one frame's script context, keyed by interned hook name.
+		struct JSFrameHooks
+		{
+			CefRefPtr<CefV8Context> Context;
+			std::unordered_map<int, JSHookList> Hooks;
+		};
+
+		typedef std::unordered_map<int64, JSFrameHooks> JSFrameHookMap;
+		typedef std::unordered_map<int, JSFrameHookMap> JSBrowserHookMap;
+		typedef std::unordered_map<CefString, int, CefStringHash> HookNameMap;
+
+		JSBrowserHookMap Hooks;
+		HookNameMap HookNames;
+
+		std::unordered_map<int, CefRefPtr<SharedStateReader> > SharedStates;
+		// browsers whose block didn't exist when last opened, retried after RADUIIPCMSG_SHAREDSTATE.
+		std::unordered_set<int> MissingSharedStates;
+
+		// Promises returned by RadiantUI.Call() waiting for the game's answer.
+		struct JSPendingCall
+		{
+			CefRefPtr<CefV8Context> Context;
+			CefRefPtr<CefV8Value> Resolve;
+			CefRefPtr<CefV8Value> Reject;
+		};
+
+		typedef std::unordered_map<int, JSPendingCall> JSPendingCallMap;
+
+		std::unordered_map<int, JSPendingCallMap> PendingCalls;
+		int NextCallId;
+
+		// ExecuteCompiledScript() functions compiled in a browser's main frame context.
+		struct JSScriptCache
 		{
 			CefRefPtr<CefV8Context> Context;
-			CefRefPtr<CefV8Value> Function;
+			std::unordered_map<int, CefRefPtr<CefV8Value> > Functions;
 		};
 
-		typedef std::map<std::pair<std::string, int>, JSHook> JSHookMap;
+		std::unordered_map<int, JSScriptCache> ScriptCaches;
+
+		// browsers that want their hooks timed.
+		std::unordered_set<int> TimedBrowsers;
 
-		JSHookMap Hooks;
+		// browser process only, 0 leaves the disk cache size to Chromium.
+		int DiskCacheSizeMB;
+		bool V8CodeCache;
+		bool ProcessPerSite;
+
+		bool ExecuteScript(CefRefPtr<CefBrowser> InBrowser, CefRefPtr<CefListValue> InRequest);
+		bool InsertFence(CefRefPtr<CefBrowser> InBrowser, int InSequence);
+
+		int InternHookName(const CefString& InHookName);
+		int FindHookName(const CefString& InHookName);
+		JSFrameHooks* FindFrameHooks(CefRefPtr<CefV8Context> InContext, bool InCreate);
+
+		bool CompleteJSCall(CefRefPtr<CefBrowser> InBrowser, CefRefPtr<CefListValue> InResult);
 
 	public:
 
-		void SetJSHook(
-			const CefString& InHookName,
-			int InBrowserID,
-			CefRefPtr<CefV8Context> InContext,
-			CefRefPtr<CefV8Value> InFunction
-			);
+		Application() : NextCallId(0), DiskCacheSizeMB(0), V8CodeCache(false), ProcessPerSite(false) {}
+
+		// Must be set before CefInitialize(), it applies to every disk cache.
+		void SetDiskCacheSize(int InSizeMB) { DiskCacheSizeMB = InSizeMB; }
 
-		void RemoveJSHook(const CefString& InHookName, int InBrowserId);
+		// Must be set before CefInitialize(), see CefRuntimeSettings.
+		void SetV8CodeCache(bool InEnabled) { V8CodeCache = InEnabled; }
+		void SetProcessPerSite(bool InEnabled) { ProcessPerSite = InEnabled; }
+
+		// Replaces all callbacks for the hook in the context's frame.
+		void SetJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction);
+
+		// Adds a callback for the hook in the context's frame. Adding the same function twice is ignored.
+		void AddJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction);
+
+		// Removes one callback, or all callbacks for the hook if InFunction is null.
+		void RemoveJSHook(const CefString& InHookName, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InFunction);
+
+		bool IsHookTimingEnabled(CefRefPtr<CefBrowser> InBrowser) const { return TimedBrowsers.count(InBrowser->GetIdentifier()) > 0; }
+
+		// Reads the browser's shared state block into InTarget, see ICefSharedState.
+		CefRefPtr<CefV8Value> ReadSharedState(CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InTarget);
+
+		// Sends a call to the game, InResolve or InReject is invoked in InContext with the answer.
+		void BeginJSCall(const CefString& InName, CefRefPtr<CefV8Value> InArguments, CefRefPtr<CefV8Context> InContext, CefRefPtr<CefV8Value> InResolve, CefRefPtr<CefV8Value> InReject);
 
 		// CefApp
+		virtual void OnRegisterCustomSchemes(CefRefPtr<CefSchemeRegistrar> registrar) OVERRIDE;
 		virtual CefRefPtr<CefBrowserProcessHandler> GetBrowserProcessHandler() OVERRIDE { return this; }
 		virtual CefRefPtr<CefRenderProcessHandler> GetRenderProcessHandler() OVERRIDE { return this; }
 
+		// CefBrowserProcessHandler methods.
+		virtual void OnBeforeChildProcessLaunch(CefRefPtr<CefCommandLine> command_line) OVERRIDE;
+
 		// CefRenderProcessHandler methods.
 		virtual void OnWebKitInitialized() OVERRIDE;
 
+		virtual void OnBrowserDestroyed(CefRefPtr<CefBrowser> browser) OVERRIDE;
+
 		virtual void OnContextReleased(CefRefPtr<CefBrowser> browser,
 			CefRefPtr<CefFrame> frame,
 			CefRefPtr<CefV8Context> context) OVERRIDE;
@@ -8,9 +8,17 @@
 #include "Application.hpp"
 #include "Variants.hpp"
 #include "WebView.hpp"
+#include "ResourceHandlers.hpp"
+#include "ContentArchives.hpp"
+#include "FileWorkers.hpp"
+#include "include/cef_origin_whitelist.h"
+#include "include/cef_request_context.h"
 
 #include "include/cef_sandbox_win.h"
 
+#include <string>
+#include <unordered_map>
+
 #if defined(CEF_USE_SANDBOX)
 // The cef_sandbox.lib static library is currently built with VS2013. It may not
 // link successfully with other VS versions.
@@ -50,7 +58,51 @@ public:
 		return GetStaticVariantFactory();
 	}
 
-	bool Initialize(ICefRuntimeCallbacks* InCallbacks)
+	virtual int MountContentArchive(const void* InData, int InSize, const char* InMountPoint) OVERRIDE
+	{
+		if (!InData || (InSize < 1))
+		{
+			return 0;
+		}
+
+		return ContentArchives::Mount(InData, InSize, InMountPoint ? InMountPoint : "");
+	}
+
+	virtual void RegisterMimeType(const char* InExtension, const char* InMimeType) OVERRIDE
+	{
+		if (InExtension && InMimeType && *InExtension && *InMimeType)
+		{
+			::RegisterMimeType(InExtension, InMimeType);
+		}
+	}
+
+	virtual bool AddRequestContext(const char* InName, const char* InCachePath) OVERRIDE
+	{
+		if (!InName || !*InName || (RequestContexts.count(InName) > 0))
+		{
+			return false;
+		}
+
+		CefRequestContextSettings ContextSettings;
+		if (InCachePath && *InCachePath)
+		{
+			CefString(&ContextSettings.cache_path).FromString(InCachePath);
+		}
+
+		CefRefPtr<CefRequestContext> Context = CefRequestContext::CreateContext(ContextSettings, nullptr);
+		if (!Context.get())
+		{
+			return false;
+		}
+
+		// scheme handlers registered globally don't reach other contexts.
+		SchemeHandlerFactory::Register(Context);
+
+		RequestContexts[InName] = Context;
+		return true;
+	}
+
+	bool Initialize(ICefRuntimeCallbacks* InCallbacks, const CefRuntimeSettings* InSettings)
 	{
 		Callbacks = InCallbacks;
 		App = new Application();
@@ -114,6 +166,18 @@ public:
 		*/
 		CefString(&Settings.browser_subprocess_path).FromASCII(szSubprocessPath);
 
+		if (InSettings)
+		{
+			if (InSettings->CachePath && *InSettings->CachePath)
+			{
+				CefString(&Settings.cache_path).FromString(InSettings->CachePath);
+			}
+
+			App->SetDiskCacheSize(InSettings->DiskCacheSizeMB);
+			App->SetV8CodeCache(InSettings->V8CodeCache);
+			App->SetProcessPerSite(InSettings->ProcessPerSite);
+		}
+
 		void* sandbox_info = NULL;
 
 #if defined(CEF_USE_SANDBOX)
@@ -129,11 +193,16 @@ public:
 			return false;
 		}
 
+		// pages served from content are allowed to fetch from game://.
+		CefAddCrossOriginWhitelistEntry("http://content", RADUI_GAME_SCHEME, "", true);
+
+		SchemeHandlerFactory::Register();
+
 		return true;
 #endif
 	}
 
-	virtual void CreateWebView(const char* InStartupURL, int InSizeX, int InSizeY, bool InTransparentPainting, ICefWebViewCallbacks *InCallbacks)
+	virtual void CreateWebView(const char* InStartupURL, int InSizeX, int InSizeY, bool InTransparentPainting, const char* InRequestContext, ICefWebViewCallbacks *InCallbacks)
 	{
 		if ((InSizeX < 1) || (InSizeY < 1) || (InStartupURL == nullptr) || (InCallbacks == nullptr))
 		{
@@ -160,7 +229,17 @@ public:
 
 		//BrowserSettings.local_storage = STATE_ENABLED;
 
-		CefBrowserHost::CreateBrowser(WindowInfo, Client.get(), CefString(InStartupURL), BrowserSettings, nullptr);
+		CefRefPtr<CefRequestContext> Context;
+		if (InRequestContext && *InRequestContext)
+		{
+			std::unordered_map<std::string, CefRefPtr<CefRequestContext> >::const_iterator It = RequestContexts.find(InRequestContext);
+			if (It != RequestContexts.end())
+			{
+				Context = It->second;
+			}
+		}
+
+		CefBrowserHost::CreateBrowser(WindowInfo, Client.get(), CefString(InStartupURL), BrowserSettings, Context);
 	}
 
 	//! Call this when you are done with the runtime API.
@@ -168,11 +247,25 @@ public:
 	{
 		Callbacks->Release();
 		App = NULL;
+		// archive entries and queued file requests hold CEF objects.
+		FileWorkers::Shutdown();
+		ContentArchives::UnmountAll();
+		CefClearSchemeHandlerFactories();
+
+		for (std::unordered_map<std::string, CefRefPtr<CefRequestContext> >::iterator It = RequestContexts.begin(); It != RequestContexts.end(); ++It)
+		{
+			It->second->ClearSchemeHandlerFactories();
+		}
+		RequestContexts.clear();
+
 		CefShutdown();
 		delete this;
 	}
 
 	ICefRuntimeCallbacks *Callbacks;
+
+	// named profiles from AddRequestContext(), only touched on the game thread.
+	std::unordered_map<std::string, CefRefPtr<CefRequestContext> > RequestContexts;
 };
 
 #if defined(WIN32)
@@ -181,10 +274,10 @@ public:
 	#define DLL_API
 #endif
 
-extern "C" DLL_API ICefRuntimeAPI* CreateCefRuntimeAPI(ICefRuntimeCallbacks* InCallbacks)
+extern "C" DLL_API ICefRuntimeAPI* CreateCefRuntimeAPI(ICefRuntimeCallbacks* InCallbacks, const CefRuntimeSettings* InSettings)
 {
 	CefRuntimeAPI *API = new CefRuntimeAPI();
-	if (!API->Initialize(InCallbacks))
+	if (!API->Initialize(InCallbacks, InSettings))
 	{
 		delete API;
 		API = nullptr;
@@ -0,0 +1,208 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#include "ContentArchives.hpp"
+
+#include "include/base/cef_lock.h"
+#include "include/cef_parser.h"
+#include "include/cef_stream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	struct IndexEntry
+	{
+		CefRefPtr<CefZipArchive::File> File;
+		std::string Hash;
+	};
+
+	typedef std::unordered_map<std::string, IndexEntry> FileIndex;
+
+	base::Lock IndexLock;
+	FileIndex Index;
+
+	// lower case with forward slashes and no leading slash, the form CefZipArchive keys by.
+	std::string NormalizePath(const std::string& InPath)
+	{
+		std::string Path = InPath;
+		std::replace(Path.begin(), Path.end(), '\\', '/');
+		std::transform(Path.begin(), Path.end(), Path.begin(), ::tolower);
+
+		const size_t Start = Path.find_first_not_of('/');
+		return (Start == std::string::npos) ? std::string() : Path.substr(Start);
+	}
+
+	// entry path to content hash, from the archive's manifest if it has one.
+	std::unordered_map<std::string, std::string> ReadManifest(CefRefPtr<CefZipArchive> InArchive)
+	{
+		std::unordered_map<std::string, std::string> Hashes;
+
+		CefRefPtr<CefZipArchive::File> File = InArchive->GetFile(ContentArchives::MANIFEST_NAME);
+		if (!File.get())
+		{
+			return Hashes;
+		}
+
+		const std::string Text((const char*)File->GetData(), File->GetDataSize());
+		CefRefPtr<CefValue> Root = CefParseJSON(Text, JSON_PARSER_RFC);
+		if (!Root.get() || (Root->GetType() != VTYPE_DICTIONARY))
+		{
+			return Hashes;
+		}
+
+		CefRefPtr<CefDictionaryValue> Files = Root->GetDictionary()->GetDictionary("files");
+		if (!Files.get())
+		{
+			return Hashes;
+		}
+
+		CefDictionaryValue::KeyList Keys;
+		Files->GetKeys(Keys);
+
+		for (size_t i = 0; i < Keys.size(); ++i)
+		{
+			Hashes[NormalizePath(Keys[i].ToString())] = Files->GetString(Keys[i]).ToString();
+		}
+
+		return Hashes;
+	}
+
+	// reads an archive entry in place, CefStreamReader::CreateForData() would copy it.
+	class ArchiveFileStream : public ICefStream
+	{
+	public:
+
+		explicit ArchiveFileStream(CefRefPtr<CefZipArchive::File> InFile)
+		: File(InFile), Data(InFile->GetData()), Size((int)InFile->GetDataSize()), Ofs(0)
+		{
+		}
+
+		virtual void Release() OVERRIDE
+		{
+			delete this;
+		}
+
+		virtual int Read(void* Ptr, int Count) OVERRIDE
+		{
+			if (Ofs >= Size)
+			{
+				return 0;
+			}
+
+			Count = std::min(Count, Size - Ofs);
+			memcpy(Ptr, Data + Ofs, Count);
+			Ofs += Count;
+			return Count;
+		}
+
+		virtual bool Seek(int Offset, SeekType Whence) OVERRIDE
+		{
+			switch (Whence)
+			{
+			case Stream_Current:
+				Offset += Ofs;
+				break;
+			case Stream_End:
+				Offset += Size;
+				break;
+			case Stream_Set:
+				break;
+			}
+
+			if ((Offset < 0) || (Offset > Size))
+			{
+				return false;
+			}
+
+			Ofs = Offset;
+			return true;
+		}
+
+		virtual int GetPos() OVERRIDE { return Ofs; }
+		virtual bool IsEOF() OVERRIDE { return Ofs >= Size; }
+
+	private:
+
+		CefRefPtr<CefZipArchive::File> File;
+		const unsigned char* Data;
+		int Size;
+		int Ofs;
+	};
+}
+
+int ContentArchives::Mount(const void* InData, int InSize, const std::string& InMountPoint)
+{
+	CefRefPtr<CefStreamReader> Reader = CefStreamReader::CreateForData(const_cast<void*>(InData), InSize);
+	if (!Reader.get())
+	{
+		return 0;
+	}
+
+	CefRefPtr<CefZipArchive> Archive(new CefZipArchive());
+	if (Archive->Load(Reader, CefString(), false) == 0)
+	{
+		return 0;
+	}
+
+	std::string MountPoint = NormalizePath(InMountPoint);
+	if (!MountPoint.empty() && (MountPoint[MountPoint.size() - 1] != '/'))
+	{
+		MountPoint += '/';
+	}
+
+	CefZipArchive::FileMap Files;
+	Archive->GetFiles(Files);
+
+	const std::unordered_map<std::string, std::string> Hashes = ReadManifest(Archive);
+
+	base::AutoLock Scope(IndexLock);
+
+	int NumMounted = 0;
+	for (CefZipArchive::FileMap::const_iterator It = Files.begin(); It != Files.end(); ++It)
+	{
+		const std::string Path = NormalizePath(It->first.ToString());
+
+		// later mounts override earlier ones, so patches can be mounted over the base UI.
+		IndexEntry& Entry = Index[MountPoint + Path];
+		Entry.File = It->second;
+
+		std::unordered_map<std::string, std::string>::const_iterator Hash = Hashes.find(Path);
+		Entry.Hash = (Hash != Hashes.end()) ? Hash->second : std::string();
+		++NumMounted;
+	}
+
+	return NumMounted;
+}
+
+void ContentArchives::UnmountAll()
+{
+	base::AutoLock Scope(IndexLock);
+	Index.clear();
+}
+
+ICefStream* ContentArchives::Open(const std::string& InPath, std::string& OutHash)
+{
+	CefRefPtr<CefZipArchive::File> File;
+	{
+		base::AutoLock Scope(IndexLock);
+
+		if (Index.empty())
+		{
+			return nullptr;
+		}
+
+		FileIndex::const_iterator It = Index.find(NormalizePath(InPath));
+		if (It == Index.end())
+		{
+			return nullptr;
+		}
+
+		File = It->second.File;
+		OutHash = It->second.Hash;
+	}
+
+	return new ArchiveFileStream(File);
+}
@@ -0,0 +1,31 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#pragma once
+
+#include "include/wrapper/cef_zip_archive.h"
+
+#include "../API/CEFRuntimeAPI.hpp"
+
+#include <string>
+
+// content:// files packed into zip archives, see ICefRuntimeAPI::MountContentArchive.
+// Each archive is inflated once at mount, entries are then found through one hash
+// index over every mounted archive. Archives written by the RadiantUI bundler carry
+// a manifest with the content hash of every entry, see MANIFEST_NAME.
+namespace ContentArchives
+{
+	// {"files":{"<path in archive>":"<hex hash>",...}} at the archive root.
+	static const char* const MANIFEST_NAME = "radiantui-manifest.json";
+
+	// InData is the whole zip file, it is not referenced after this returns. Returns the
+	// number of files mounted, 0 if the archive couldn't be read.
+	int Mount(const void* InData, int InSize, const std::string& InMountPoint);
+
+	// Drops every archive, must happen before CefShutdown().
+	void UnmountAll();
+
+	// InPath is relative to the content root, as in content://<InPath>. Returns null if
+	// no mounted archive has the file. OutHash is the entry's hash from its archive's
+	// manifest, empty if it wasn't listed.
+	ICefStream* Open(const std::string& InPath, std::string& OutHash);
+}
@@ -4,7 +4,8 @@
 
 class ICefRuntimeAPI;
 class ICefRuntimeCallbacks;
+struct CefRuntimeSettings;
 
-typedef ICefRuntimeAPI* (*CreateCefRuntimeAPI)(ICefRuntimeCallbacks*);
+typedef ICefRuntimeAPI* (*CreateCefRuntimeAPI)(ICefRuntimeCallbacks*, const CefRuntimeSettings*);
 
 #define CEFCREATERUNTIMEAPI_SIG "CreateCefRuntimeAPI"
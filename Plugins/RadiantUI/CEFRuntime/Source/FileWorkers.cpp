@@ -0,0 +1,88 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#include "FileWorkers.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::mutex QueueLock;
+	std::condition_variable QueueSignal;
+	std::deque<std::function<void()> > Queue;
+	std::vector<std::thread> Workers;
+	bool Stopping = false;
+
+	void WorkerMain()
+	{
+		for (;;)
+		{
+			std::function<void()> Task;
+			{
+				std::unique_lock<std::mutex> Scope(QueueLock);
+				QueueSignal.wait(Scope, []() { return Stopping || !Queue.empty(); });
+
+				if (Stopping)
+				{
+					return;
+				}
+
+				Task = std::move(Queue.front());
+				Queue.pop_front();
+			}
+
+			Task();
+		}
+	}
+}
+
+void FileWorkers::Post(const std::function<void()>& InTask)
+{
+	{
+		std::lock_guard<std::mutex> Scope(QueueLock);
+
+		if (Stopping)
+		{
+			return;
+		}
+
+		if (Workers.empty())
+		{
+			// reads are mostly page cache hits, a few threads are enough to hide the slow ones.
+			const unsigned NumWorkers = std::max(2u, std::min(4u, std::thread::hardware_concurrency() / 2));
+			for (unsigned i = 0; i < NumWorkers; ++i)
+			{
+				Workers.push_back(std::thread(&WorkerMain));
+			}
+		}
+
+		Queue.push_back(InTask);
+	}
+
+	QueueSignal.notify_one();
+}
+
+void FileWorkers::Shutdown()
+{
+	std::vector<std::thread> Joining;
+	std::deque<std::function<void()> > Dropped;
+	{
+		std::lock_guard<std::mutex> Scope(QueueLock);
+		Stopping = true;
+		Joining.swap(Workers);
+		Dropped.swap(Queue);
+	}
+
+	QueueSignal.notify_all();
+
+	for (size_t i = 0; i < Joining.size(); ++i)
+	{
+		Joining[i].join();
+	}
+
+	// dropped tasks release their resource handlers here, outside the lock.
+}
@@ -0,0 +1,16 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#pragma once
+
+#include <functional>
+
+// Small thread pool for blocking file access, so neither the CEF IO thread nor CEF's
+// own single file thread ever waits on disk for content:// requests.
+namespace FileWorkers
+{
+	// Runs InTask on a worker, starting the pool on first use.
+	void Post(const std::function<void()>& InTask);
+
+	// Joins the workers and drops queued tasks, must happen before CefShutdown().
+	void Shutdown();
+}
@@ -7,80 +7,77 @@
 #include "Handler.hpp"
 #include "Application.hpp"
 #include "include/cef_parser.h"
-#include "include/wrapper/cef_stream_resource_handler.h"
 #include "Variants.hpp"
+#include "ResourceHandlers.hpp"
+#include "ContentArchives.hpp"
+#include <cstring>
 #include <sstream>
+#include <vector>
 #include <algorithm>
 
-class CefStreamWrapper : public CefReadHandler
+namespace
 {
-	IMPLEMENT_REFCOUNTING(CefStreamWrapper);
-public:
+	// live browsers by id, for SchemeHandlerFactory.
+	base::Lock BrowsersLock;
+	std::unordered_map<int, Handler*> Browsers;
+}
 
-	CefStreamWrapper(ICefStream* InStream) : Stream(InStream) {}
+CefRefPtr<Handler> Handler::FindByBrowser(int InBrowserId)
+{
+	base::AutoLock Scope(BrowsersLock);
 
-	virtual ~CefStreamWrapper()
-	{
-		if (Stream)
-		{
-			Stream->Release();
-		}
-	}
+	std::unordered_map<int, Handler*>::const_iterator It = Browsers.find(InBrowserId);
+	return (It != Browsers.end()) ? It->second : nullptr;
+}
 
-	///
-	// Read raw binary data.
-	///
-	/*--cef()--*/
-	virtual size_t Read(void* ptr, size_t size, size_t n) OVERRIDE
-	{
-		return Stream->Read(ptr, (int)(size*n));
-	}
+void SchemeHandlerFactory::Register(CefRefPtr<CefRequestContext> InContext)
+{
+	CefRefPtr<SchemeHandlerFactory> Factory(new SchemeHandlerFactory());
 
-	///
-	// Seek to the specified offset position. |whence| may be any one of
-	// SEEK_CUR, SEEK_END or SEEK_SET. Return zero on success and non-zero on
-	// failure.
-	///
-	/*--cef()--*/
-	virtual int Seek(int64 offset, int whence)
+	if (InContext.get())
 	{
-		return Stream->Seek((int)offset, (ICefStream::SeekType)whence) ? 1 : 0;
+		InContext->RegisterSchemeHandlerFactory("http", "content", Factory.get());
+		InContext->RegisterSchemeHandlerFactory(RADUI_GAME_SCHEME, "", Factory.get());
 	}
-
-	///
-	// Return the current offset position.
-	///
-	/*--cef()--*/
-	virtual int64 Tell()
+	else
 	{
-		return (int64)Stream->GetPos();
+		CefRegisterSchemeHandlerFactory("http", "content", Factory.get());
+		CefRegisterSchemeHandlerFactory(RADUI_GAME_SCHEME, "", Factory.get());
 	}
+}
 
-	///
-	// Return non-zero if at end of file.
-	///
-	/*--cef()--*/
-	virtual int Eof()
+CefRefPtr<CefResourceHandler> SchemeHandlerFactory::Create(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, const CefString& scheme_name, CefRefPtr<CefRequest> request)
+{
+	if (!browser.get())
 	{
-		return Stream->IsEOF() ? 1 : 0;
+		return NULL;
 	}
 
-	virtual bool MayBlock()
+	CefRefPtr<Handler> Client = Handler::FindByBrowser(browser->GetIdentifier());
+	if (!Client.get())
 	{
-		return false;
+		return NULL;
 	}
 
-private:
-
-	ICefStream* Stream;
-};
+	return Client->CreateResourceHandler(request);
+}
 
-Handler::Handler(int InSizeX, int InSizeY, ICefWebView* InWebView, ICefWebViewCallbacks *InCallbacks) : SizeX(InSizeX), SizeY(InSizeY), WebView(InWebView), Callbacks(InCallbacks), InEditableField(false)
+Handler::Handler(int InSizeX, int InSizeY, ICefWebView* InWebView, ICefWebViewCallbacks *InCallbacks) : SizeX(InSizeX), SizeY(InSizeY), WebView(InWebView), Callbacks(InCallbacks), InEditableField(false), NextScriptRequest(0), AckedFence(0), PaintedFence(0), HookTiming(false)
 {
 }
 
 Handler::~Handler()
 {
+	std::unordered_map<int, ICefScriptCallback*> Abandoned;
+	{
+		base::AutoLock Scope(ScriptLock);
+		Abandoned.swap(PendingScripts);
+	}
+
+	for (std::unordered_map<int, ICefScriptCallback*>::iterator it = Abandoned.begin(); it != Abandoned.end(); ++it)
+	{
+		it->second->ScriptCompleted(nullptr, "the WebView was destroyed");
+	}
 }
 
 void Handler::Resize(int InSizeX, int InSizeY)
@@ -117,6 +114,126 @@ void Handler::LoadURL(const CefString& InURL)
 	}
 }
 
+void Handler::SetHookTimingEnabled(bool InEnabled)
+{
+	HookTiming = InEnabled;
+
+	if (Browser.get())
+	{
+		// the renderer only stamps page to game hooks when asked to.
+		CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_HOOKTIMING);
+		Message->GetArgumentList()->SetBool(0, InEnabled);
+		Browser->SendProcessMessage(PID_RENDERER, Message);
+	}
+}
+
+ICefStream* Handler::OpenFileStream(const std::string& InPath)
+{
+	base::AutoLock Scope(FileLock);
+
+	if (!WebView)
+	{
+		// closed while the request was queued.
+		return nullptr;
+	}
+
+	return Callbacks->GetFileStream(InPath.c_str());
+}
+
+int Handler::CompileScript(const char* InSource)
+{
+	base::AutoLock Scope(ScriptLock);
+	Scripts.push_back(InSource);
+	return (int)Scripts.size();
+}
+
+void Handler::ExecuteScript(int InScript, const char* InSource, ICefScriptCallback* InCallback)
+{
+	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_EXECUTE);
+	CefRefPtr<CefListValue> Arguments = Message->GetArgumentList();
+	int RequestId = 0;
+	bool bKnownScript = true;
+
+	{
+		base::AutoLock Scope(ScriptLock);
+
+		if (InScript > (int)Scripts.size())
+		{
+			bKnownScript = false;
+		}
+		else
+		{
+			if (InScript > 0)
+			{
+				// the source goes along so a renderer that hasn't seen the handle yet can compile it.
+				InSource = Scripts[InScript - 1].c_str();
+			}
+
+			if (InCallback)
+			{
+				RequestId = ++NextScriptRequest;
+				PendingScripts[RequestId] = InCallback;
+			}
+
+			Arguments->SetInt(0, RequestId);
+			Arguments->SetInt(1, InScript);
+			Arguments->SetString(2, InSource);
+		}
+	}
+
+	if (!bKnownScript)
+	{
+		if (InCallback)
+		{
+			InCallback->ScriptCompleted(nullptr, "unknown script handle");
+		}
+		return;
+	}
+
+	if (!Browser.get())
+	{
+		if (RequestId)
+		{
+			Arguments->SetBool(1, false);
+			Arguments->SetString(2, "the page has not been created yet");
+			CompleteScript(Arguments);
+		}
+		return;
+	}
+
+	Browser->SendProcessMessage(PID_RENDERER, Message);
+}
+
+void Handler::CompleteScript(CefRefPtr<CefListValue> InResult)
+{
+	ICefScriptCallback* Callback = nullptr;
+	{
+		base::AutoLock Scope(ScriptLock);
+		std::unordered_map<int, ICefScriptCallback*>::iterator it = PendingScripts.find(InResult->GetInt(0));
+		if (it == PendingScripts.end())
+		{
+			return;
+		}
+
+		Callback = it->second;
+		PendingScripts.erase(it);
+	}
+
+	if (InResult->GetBool(1))
+	{
+		ICefRuntimeVariant* Result = CefListItemToVariant(InResult, 2);
+		Callback->ScriptCompleted(Result, nullptr);
+		if (Result)
+		{
+			Result->Release();
+		}
+	}
+	else
+	{
+		Callback->ScriptCompleted(nullptr, InResult->GetString(2).ToString().c_str());
+	}
+}
+
 bool Handler::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser, CefProcessId source_process, CefRefPtr<CefProcessMessage> message)
 {
 	ASSERT(source_process == PID_RENDERER);
@@ -126,10 +243,64 @@ bool Handler::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser, CefProcess
 		InEditableField = message->GetArgumentList()->GetBool(0);
 		Callbacks->FocusedNodeChanged(InEditableField);
 	}
+	else if (message->GetName() == RADUIIPCMSG_FENCEACK)
+	{
+		{
+			base::AutoLock lock_scope(lock_);
+			AckedFence = std::max(AckedFence, message->GetArgumentList()->GetInt(0));
+		}
+
+		// the acknowledged frame may already have been painted, make sure another one follows.
+		// the ack can arrive after the browser has closed.
+		if (Browser.get())
+		{
+			GetHost()->Invalidate(PET_VIEW);
+		}
+	}
+	else if (message->GetName() == RADUIIPCMSG_EXECUTERESULT)
+	{
+		CompleteScript(message->GetArgumentList());
+	}
+	else if (message->GetName() == RADUIIPCMSG_CALL)
+	{
+		CefRefPtr<CefListValue> MessageArguments = message->GetArgumentList();
+		ICefRuntimeVariantList* Arguments = CefListToVariant(MessageArguments->GetList(2));
+		Callbacks->ExecuteJSCall(MessageArguments->GetInt(0), MessageArguments->GetString(1).ToString().c_str(), Arguments);
+		Arguments->Release();
+	}
+	else if (message->GetName() == RADUIIPCMSG_HOOKTIMING)
+	{
+		CefRefPtr<CefListValue> MessageArguments = message->GetArgumentList();
+
+		CefRuntimeHookTiming Timing;
+		Timing.BrowserTime = MessageArguments->GetDouble(1);
+		Timing.PageTime = MessageArguments->GetDouble(2);
+		Timing.PageHandledTime = MessageArguments->GetDouble(3);
+		Callbacks->JSHookDelivered(MessageArguments->GetString(0).ToString().c_str(), Timing);
+	}
 	else
 	{
-		ICefRuntimeVariantList* Arguments = CefListToVariant(message->GetArgumentList());
-		Callbacks->ExecuteJSHook(message->GetName().ToString().c_str(), Arguments);
+		std::string HookName = message->GetName().ToString();
+		CefRefPtr<CefListValue> MessageArguments = message->GetArgumentList();
+		CefRuntimeHookTiming Timing;
+		CefRuntimeHookTiming* TimingPtr = nullptr;
+
+		const size_t PrefixLength = strlen(RADUIIPCMSG_TIMEDPREFIX);
+		if ((HookName.compare(0, PrefixLength, RADUIIPCMSG_TIMEDPREFIX) == 0) && (MessageArguments->GetSize() > 0))
+		{
+			// the page's timestamp rides along as the last argument.
+			const int TimeIndex = (int)MessageArguments->GetSize() - 1;
+			Timing.BrowserTime = CefRuntimeTimestamp();
+			Timing.PageTime = MessageArguments->GetDouble(TimeIndex);
+			Timing.PageHandledTime = 0.0;
+			MessageArguments->Remove(TimeIndex);
+
+			HookName = HookName.substr(PrefixLength);
+			TimingPtr = &Timing;
+		}
+
+		ICefRuntimeVariantList* Arguments = CefListToVariant(MessageArguments);
+		Callbacks->ExecuteJSHook(HookName.c_str(), Arguments, TimingPtr);
 		Arguments->Release();
 	}
 
@@ -208,6 +379,12 @@ bool Handler::OnBeforePopup(CefRefPtr<CefBrowser> browser,
 void Handler::OnAfterCreated(CefRefPtr<CefBrowser> browser)
 {
 	Browser = browser;
+
+	{
+		base::AutoLock Scope(BrowsersLock);
+		Browsers[browser->GetIdentifier()] = this;
+	}
+
 	Callbacks->WebViewCreated(WebView);
 }
 
@@ -225,8 +402,15 @@ void Handler::OnBeforeClose(CefRefPtr<CefBrowser> browser)
 {
 	if ((Browser.get() != NULL) && (Browser->GetIdentifier() == browser->GetIdentifier()))
 	{
+		{
+			base::AutoLock Scope(BrowsersLock);
+			Browsers.erase(browser->GetIdentifier());
+		}
+
 		if (Callbacks)
 		{
+			// waits out any file being opened on a worker.
+			base::AutoLock Scope(FileLock);
 			Callbacks->Release(WebView);
 			WebView = nullptr;
 		}
@@ -272,6 +456,34 @@ void Handler::OnLoadError(CefRefPtr<CefBrowser> browser,
 	frame->LoadString(ss.str(), failedUrl);
 }
 
+namespace
+{
+	void GetPostBody(CefRefPtr<CefRequest> InRequest, std::vector<char>& OutBody)
+	{
+		CefRefPtr<CefPostData> PostData = InRequest->GetPostData();
+		if (!PostData.get())
+		{
+			return;
+		}
+
+		CefPostData::ElementVector Elements;
+		PostData->GetElements(Elements);
+
+		for (CefPostData::ElementVector::iterator it = Elements.begin(); it != Elements.end(); ++it)
+		{
+			if ((*it)->GetType() == PDE_TYPE_BYTES)
+			{
+				const size_t Offset = OutBody.size();
+				OutBody.resize(Offset + (*it)->GetBytesCount());
+				if (Offset < OutBody.size())
+				{
+					(*it)->GetBytes((*it)->GetBytesCount(), &OutBody[Offset]);
+				}
+			}
+		}
+	}
+}
+
 bool Handler::ParseURL(const std::string& URL, std::string& OutPath, std::string& OutMimeType)
 {
 	/*if ((URL.find(".com") == std::string::npos)
@@ -295,46 +507,7 @@ bool Handler::ParseURL(const std::string& URL, std::string& OutPath, std::string
 			OutPath = OutPath.substr(1);
 		}
 
-		// Figure out mime type.
-		size_t pos = OutPath.rfind(".");
-
-		OutMimeType = "text/plain";
-
-		if (pos != std::string::npos)
-		{
-			std::string Ext = OutPath.substr(pos + 1);
-
-			std::transform(Ext.begin(), Ext.end(), Ext.begin(), ::tolower);
-
-			if (Ext == "html")
-			{
-				OutMimeType = "text/html";
-			}
-			else if (Ext == "png")
-			{
-				OutMimeType = "image/png";
-			}
-			else if (Ext == "jpg")
-			{
-				OutMimeType = "image/jpg";
-			}
-			else if (Ext == "bmp")
-			{
-				OutMimeType = "image/bmp";
-			}
-			else if (Ext == "svg")
-			{
-				OutMimeType = "image/svg+xml";
-			}
-			else if (Ext == "css")
-			{
-				OutMimeType = "text/css";
-			}
-			else if (Ext == "js")
-			{
-				OutMimeType = "text/javascript";
-			}
-		}
+		OutMimeType = GetMimeType(OutPath);
 
 		return true;
 	}
@@ -343,23 +516,44 @@ bool Handler::ParseURL(const std::string& URL, std::string& OutPath, std::string
 }
 
 // CefRequestHandler methods
-CefRefPtr<CefResourceHandler> Handler::GetResourceHandler(
-	CefRefPtr<CefBrowser> browser,
-	CefRefPtr<CefFrame> frame,
-	CefRefPtr<CefRequest> request
-	)
+CefRefPtr<CefResourceHandler> Handler::CreateResourceHandler(CefRefPtr<CefRequest> request)
 {
-	std::string Path, MimeType;
+	std::string Host, Path, MimeType, Query;
 
-	if (ParseURL(request->GetURL(), Path, MimeType))
+	if (ParseGameURL(request->GetURL(), Host, Path, Query))
 	{
-		ICefStream* CefStream = Callbacks->GetFileStream(Path.c_str());
-		if (CefStream)
+		ICefDataStream* DataStream = nullptr;
+
+		if (Host == "data")
+		{
+			DataStream = Callbacks->CreateDataStream(Path.substr(1).c_str(), Query.c_str());
+		}
+		else if (Host == "api")
+		{
+			std::vector<char> Body;
+			GetPostBody(request, Body);
+			DataStream = Callbacks->CreateApiStream(request->GetMethod().ToString().c_str(), Path.c_str(), Query.c_str(), Body.empty() ? nullptr : &Body[0], (int)Body.size());
+		}
+		else if (Host == "texture")
 		{
-			CefRefPtr<CefReadHandler> ReadHandler(new CefStreamWrapper(CefStream));
-			CefRefPtr<CefStreamReader> StreamReader(CefStreamReader::CreateForHandler(ReadHandler));
-			return new CefStreamResourceHandler(MimeType, StreamReader);
+			DataStream = Callbacks->CreateTextureStream(Path.c_str(), Query.c_str());
 		}
+
+		if (DataStream)
+		{
+			return new DataStreamResourceHandler(DataStream);
+		}
+	}
+	else if (ParseURL(request->GetURL(), Path, MimeType))
+	{
+		// opened and read on FileWorkers, the game's file access may block.
+		CefRefPtr<Handler> Client(this);
+		return new FileResourceHandler(MimeType, [Client, Path](std::string& OutHash)
+		{
+			// loose files can be edited while running, only archive entries are hashed.
+			ICefStream* Stream = ContentArchives::Open(Path, OutHash);
+			return Stream ? Stream : Client->OpenFileStream(Path);
+		});
 	}
 	return NULL;
 }
@@ -472,5 +666,11 @@ void Handler::OnPaint(
 		Callbacks->Repaint(NumRegions, Regions, buffer, width, height);
 	}
 
+	if (AckedFence > PaintedFence)
+	{
+		PaintedFence = AckedFence;
+		Callbacks->FenceReached(PaintedFence);
+	}
+
 	Callbacks->LeaveCriticalSection();
 }
\ No newline at end of file
@@ -9,12 +9,16 @@
 #include "include/cef_app.h"
 #include "include/cef_client.h"
 #include "include/base/cef_lock.h"
+#include "include/cef_request_context.h"
 #include "include/cef_request_handler.h"
+#include "include/cef_scheme.h"
 
 #include "../API/CEFRuntimeAPI.hpp"
 
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class Handler : public CefClient,
 	public CefContextMenuHandler,
@@ -43,6 +47,23 @@ class Handler : public CefClient,
 		ICefWebViewCallbacks *Callbacks;
 		CefRefPtr<CefBrowser> Browser;
 
+		// ExecuteScript() state, guarded by ScriptLock.
+		base::Lock ScriptLock;
+		std::vector<std::string> Scripts;
+		std::unordered_map<int, ICefScriptCallback*> PendingScripts;
+		int NextScriptRequest;
+
+		// newest fence the page has acknowledged, and the newest reported after a paint. Guarded by lock_.
+		int AckedFence;
+		int PaintedFence;
+
+		volatile bool HookTiming;
+
+		// held while the game opens a content:// file, so the view can't be released under it.
+		base::Lock FileLock;
+
+		void CompleteScript(CefRefPtr<CefListValue> InResult);
+
 	public:
 
 		Handler(int InSizeX, int InSizeY, ICefWebView* InWebView, ICefWebViewCallbacks *InCallbacks);
@@ -53,6 +74,16 @@ class Handler : public CefClient,
 		void CloseExistingBrowser();
 		void LoadURL(const CefString& InURL);
 
+		// InScript is a CompileScript() handle, or 0 to run InSource once.
+		void ExecuteScript(int InScript, const char* InSource, ICefScriptCallback* InCallback);
+		int CompileScript(const char* InSource);
+
+		// Called on FileWorkers, null if the file doesn't exist or the browser has closed.
+		ICefStream* OpenFileStream(const std::string& InPath);
+
+		void SetHookTimingEnabled(bool InEnabled);
+		bool IsHookTimingEnabled() const { return HookTiming; }
+
 		CefRefPtr<CefBrowser> GetBrowser() { return Browser; }
 		CefRefPtr<CefBrowserHost> GetHost() { return Browser->GetHost(); }
 
@@ -162,13 +193,13 @@ class Handler : public CefClient,
 			const CefString& failedUrl
 			) OVERRIDE;
 
-		// CefRequestHandler methods
-		virtual CefRefPtr<CefResourceHandler> GetResourceHandler(
-			CefRefPtr<CefBrowser> browser,
-			CefRefPtr<CefFrame> frame,
-			CefRefPtr<CefRequest> request
-			) OVERRIDE;
+		// Serves http://content/ and game:// requests for this browser, see SchemeHandlerFactory.
+		CefRefPtr<CefResourceHandler> CreateResourceHandler(CefRefPtr<CefRequest> request);
+
+		// The handler of a live browser, null once it has closed.
+		static CefRefPtr<Handler> FindByBrowser(int InBrowserId);
 
+		// CefRequestHandler methods
 		virtual bool OnQuotaRequest(CefRefPtr<CefBrowser> browser,
 			const CefString& origin_url,
 			int64 new_size,
@@ -206,6 +237,24 @@ class Handler : public CefClient,
 			) OVERRIDE;
 };
 
+// Registered once for http://content/ and game:// so only those requests reach our code,
+// everything else stays on CEF's own path. Requests are routed to the Handler of the
+// browser they come from. Called on the IO thread.
+class SchemeHandlerFactory : public CefSchemeHandlerFactory
+{
+	IMPLEMENT_REFCOUNTING(SchemeHandlerFactory);
+public:
+
+	// Registers content:// and game:// with InContext, or the global context if null.
+	static void Register(CefRefPtr<CefRequestContext> InContext = nullptr);
+
+	virtual CefRefPtr<CefResourceHandler> Create(CefRefPtr<CefBrowser> browser,
+		CefRefPtr<CefFrame> frame,
+		const CefString& scheme_name,
+		CefRefPtr<CefRequest> request
+		) OVERRIDE;
+};
+
 /*
 class SimpleHandler : public CefClient,
                       public CefDisplayHandler,
@@ -0,0 +1,598 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#include "ResourceHandlers.hpp"
+#include "FileWorkers.hpp"
+#include "Assert.hpp"
+
+#include "include/cef_parser.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+
+bool ParseGameURL(const std::string& InURL, std::string& OutHost, std::string& OutPath, std::string& OutQuery)
+{
+	CefURLParts Parts;
+	if (!CefParseURL(InURL, Parts))
+	{
+		return false;
+	}
+
+	if ((CefString(&Parts.scheme) != RADUI_GAME_SCHEME) || (Parts.path.length < 2))
+	{
+		return false;
+	}
+
+	OutHost = CefString(&Parts.host);
+	OutPath = CefString(&Parts.path);
+	OutQuery = CefString(&Parts.query);
+	return true;
+}
+
+DataStreamResourceHandler::DataStreamResourceHandler(ICefDataStream* InStream) : Stream(InStream)
+{
+	Stream->SetListener(this);
+}
+
+DataStreamResourceHandler::~DataStreamResourceHandler()
+{
+	CloseStream();
+}
+
+void DataStreamResourceHandler::CloseStream()
+{
+	ICefDataStream* OldStream;
+	{
+		base::AutoLock Scope(Lock);
+		OldStream = Stream;
+		Stream = nullptr;
+		PendingRead = nullptr;
+	}
+
+	if (OldStream)
+	{
+		// once this returns the stream won't call DataAvailable() again.
+		OldStream->SetListener(nullptr);
+		OldStream->Release();
+	}
+}
+
+bool DataStreamResourceHandler::ProcessRequest(CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback)
+{
+	ICefDataStream* CurrentStream;
+	{
+		base::AutoLock Scope(Lock);
+		CurrentStream = Stream;
+		PendingRead = callback;
+	}
+
+	if (CurrentStream && CurrentStream->HasHeaders())
+	{
+		{
+			base::AutoLock Scope(Lock);
+			PendingRead = nullptr;
+		}
+
+		callback->Continue();
+	}
+
+	// otherwise DataAvailable() continues once the game has answered.
+	return true;
+}
+
+void DataStreamResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response, int64& response_length, CefString& redirectUrl)
+{
+	const int Status = Stream->GetStatus();
+	response->SetStatus(Status);
+	response->SetStatusText((Status == 200) ? "OK" : "");
+	response->SetMimeType(Stream->GetMimeType());
+
+	const char* CacheControl = Stream->GetCacheControl();
+
+	CefResponse::HeaderMap Headers;
+	// no CORS headers, http://content is already whitelisted for game:// and nothing else
+	// may read game data.
+	Headers.insert(std::make_pair("Cache-Control", CacheControl ? CacheControl : "no-store"));
+	response->SetHeaderMap(Headers);
+
+	response_length = -1;
+}
+
+bool DataStreamResourceHandler::ReadResponse(void* data_out, int bytes_to_read, int& bytes_read, CefRefPtr<CefCallback> callback)
+{
+	REQUIRE_IO_THREAD()
+
+	bytes_read = 0;
+
+	ICefDataStream* CurrentStream;
+	{
+		// park the callback first so data arriving during Read() can't be missed.
+		base::AutoLock Scope(Lock);
+		CurrentStream = Stream;
+		PendingRead = callback;
+	}
+
+	if (!CurrentStream)
+	{
+		return false;
+	}
+
+	const int Result = CurrentStream->Read(data_out, bytes_to_read);
+	if (Result != 0)
+	{
+		base::AutoLock Scope(Lock);
+		PendingRead = nullptr;
+	}
+
+	if (Result < 0)
+	{
+		// end of stream.
+		return false;
+	}
+
+	bytes_read = Result;
+	return true;
+}
+
+void DataStreamResourceHandler::Cancel()
+{
+	ICefDataStream* CurrentStream;
+	{
+		base::AutoLock Scope(Lock);
+		CurrentStream = Stream;
+	}
+
+	if (CurrentStream)
+	{
+		CurrentStream->Cancel();
+	}
+
+	CloseStream();
+}
+
+void DataStreamResourceHandler::DataAvailable()
+{
+	CefRefPtr<CefCallback> Callback;
+	{
+		base::AutoLock Scope(Lock);
+		Callback = PendingRead;
+		PendingRead = nullptr;
+	}
+
+	if (Callback.get())
+	{
+		Callback->Continue();
+	}
+}
+
+namespace
+{
+	base::Lock MimeTypeLock;
+	std::unordered_map<std::string, std::string> MimeTypes;
+
+	void AddDefaultMimeTypes()
+	{
+		static const char* Defaults[][2] =
+		{
+			{ "html", "text/html" },
+			{ "htm", "text/html" },
+			{ "css", "text/css" },
+			{ "js", "text/javascript" },
+			{ "mjs", "text/javascript" },
+			{ "json", "application/json" },
+			{ "map", "application/json" },
+			{ "xml", "text/xml" },
+			{ "txt", "text/plain" },
+			{ "wasm", "application/wasm" },
+			{ "png", "image/png" },
+			{ "jpg", "image/jpeg" },
+			{ "jpeg", "image/jpeg" },
+			{ "gif", "image/gif" },
+			{ "bmp", "image/bmp" },
+			{ "svg", "image/svg+xml" },
+			{ "webp", "image/webp" },
+			{ "ico", "image/x-icon" },
+			{ "woff", "font/woff" },
+			{ "woff2", "font/woff2" },
+			{ "ttf", "font/ttf" },
+			{ "otf", "font/otf" },
+			{ "mp4", "video/mp4" },
+			{ "webm", "video/webm" },
+			{ "ogv", "video/ogg" },
+			{ "ogg", "audio/ogg" },
+			{ "mp3", "audio/mpeg" },
+			{ "wav", "audio/wav" }
+		};
+
+		for (size_t i = 0; i < sizeof(Defaults) / sizeof(Defaults[0]); ++i)
+		{
+			MimeTypes[Defaults[i][0]] = Defaults[i][1];
+		}
+	}
+
+	std::string ToLowerExtension(const std::string& InExtension)
+	{
+		std::string Ext = (!InExtension.empty() && (InExtension[0] == '.')) ? InExtension.substr(1) : InExtension;
+		std::transform(Ext.begin(), Ext.end(), Ext.begin(), ::tolower);
+		return Ext;
+	}
+
+	// digits only. values too large for an int64 saturate, they are out of range anyway.
+	bool ParseRangeOffset(const std::string& InText, int64& OutOffset)
+	{
+		if (InText.empty())
+		{
+			OutOffset = -1;
+			return true;
+		}
+
+		int64 Value = 0;
+		for (size_t i = 0; i < InText.size(); ++i)
+		{
+			const char C = InText[i];
+			if ((C < '0') || (C > '9'))
+			{
+				return false;
+			}
+
+			Value = (Value > (LLONG_MAX - 9) / 10) ? LLONG_MAX : (Value * 10 + (C - '0'));
+		}
+
+		OutOffset = Value;
+		return true;
+	}
+
+	// bytes=<first>-<last>, bytes=<first>- or bytes=-<suffix length>. Multiple ranges aren't
+	// supported, those requests get the whole file.
+	bool ParseRange(const std::string& InHeader, int64& OutFirst, int64& OutLast)
+	{
+		if ((InHeader.compare(0, 6, "bytes=") != 0) || (InHeader.find(',') != std::string::npos))
+		{
+			return false;
+		}
+
+		const std::string Spec = InHeader.substr(6);
+		const size_t Dash = Spec.find('-');
+		if (Dash == std::string::npos)
+		{
+			return false;
+		}
+
+		const std::string First = Spec.substr(0, Dash);
+		const std::string Last = Spec.substr(Dash + 1);
+		if (First.empty() && Last.empty())
+		{
+			return false;
+		}
+
+		return ParseRangeOffset(First, OutFirst) && ParseRangeOffset(Last, OutLast);
+	}
+}
+
+void RegisterMimeType(const std::string& InExtension, const std::string& InMimeType)
+{
+	base::AutoLock Scope(MimeTypeLock);
+
+	if (MimeTypes.empty())
+	{
+		AddDefaultMimeTypes();
+	}
+
+	MimeTypes[ToLowerExtension(InExtension)] = InMimeType;
+}
+
+std::string GetMimeType(const std::string& InPath)
+{
+	const size_t Dot = InPath.rfind('.');
+	if ((Dot == std::string::npos) || (InPath.find('/', Dot) != std::string::npos))
+	{
+		return "text/plain";
+	}
+
+	const std::string Ext = ToLowerExtension(InPath.substr(Dot + 1));
+
+	base::AutoLock Scope(MimeTypeLock);
+
+	if (MimeTypes.empty())
+	{
+		AddDefaultMimeTypes();
+	}
+
+	std::unordered_map<std::string, std::string>::const_iterator It = MimeTypes.find(Ext);
+	return (It != MimeTypes.end()) ? It->second : "text/plain";
+}
+
+FileResourceHandler::FileResourceHandler(const std::string& InMimeType, const FOpenFunc& InOpen)
+: MimeType(InMimeType)
+, OpenStream(InOpen)
+, Stream(nullptr)
+, Length(-1)
+, RangeFirst(-1)
+, RangeLast(-1)
+, Remaining(-1)
+, Status(404)
+, BufferOffset(0)
+, EndOfStream(false)
+, Cancelled(false)
+{
+}
+
+FileResourceHandler::~FileResourceHandler()
+{
+	if (Stream)
+	{
+		Stream->Release();
+	}
+}
+
+bool FileResourceHandler::ProcessRequest(CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback)
+{
+	CefRequest::HeaderMap Headers;
+	request->GetHeaderMap(Headers);
+
+	for (CefRequest::HeaderMap::const_iterator It = Headers.begin(); It != Headers.end(); ++It)
+	{
+		const std::string Name = It->first.ToString();
+
+		if (_stricmp(Name.c_str(), "Range") == 0)
+		{
+			int64 First, Last;
+			if (ParseRange(It->second.ToString(), First, Last))
+			{
+				base::AutoLock Scope(Lock);
+				RangeFirst = First;
+				RangeLast = Last;
+			}
+		}
+		else if (_stricmp(Name.c_str(), "If-None-Match") == 0)
+		{
+			base::AutoLock Scope(Lock);
+			RequestETag = It->second.ToString();
+		}
+	}
+
+	CefRefPtr<FileResourceHandler> Self(this);
+	FileWorkers::Post([Self, callback]()
+	{
+		Self->Open(callback);
+	});
+
+	return true;
+}
+
+void FileResourceHandler::Open(CefRefPtr<CefCallback> InCallback)
+{
+	int64 First, Last;
+	{
+		base::AutoLock Scope(Lock);
+		if (Cancelled)
+		{
+			return;
+		}
+
+		First = RangeFirst;
+		Last = RangeLast;
+	}
+
+	std::string NewHash;
+	ICefStream* NewStream = OpenStream(NewHash);
+	int64 NewLength = -1;
+	int NewStatus = NewStream ? 200 : 404;
+	int64 NewRemaining = -1;
+
+	bool NotModified = false;
+	if (NewStream && !NewHash.empty())
+	{
+		base::AutoLock Scope(Lock);
+		NotModified = (RequestETag == "\"" + NewHash + "\"");
+	}
+
+	if (NotModified)
+	{
+		// the browser already has these bytes, don't read them again.
+		NewStatus = 304;
+		NewRemaining = 0;
+	}
+	else if (NewStream && NewStream->Seek(0, ICefStream::Stream_End))
+	{
+		NewLength = NewStream->GetPos();
+		NewStream->Seek(0, ICefStream::Stream_Set);
+		NewRemaining = NewLength;
+
+		const bool HasRange = (First >= 0) || (Last >= 0);
+		if (HasRange)
+		{
+			if (First < 0)
+			{
+				// suffix range, the last <Last> bytes.
+				First = std::max<int64>(NewLength - Last, 0);
+				Last = NewLength - 1;
+			}
+			else if ((Last < 0) || (Last >= NewLength))
+			{
+				Last = NewLength - 1;
+			}
+
+			// ICefStream offsets are ints, nothing past INT_MAX can be seeked to.
+			if ((First >= NewLength) || (First > Last) || (First > INT_MAX))
+			{
+				NewStatus = 416;
+				NewRemaining = 0;
+			}
+			else if (NewStream->Seek(static_cast<int>(First), ICefStream::Stream_Set))
+			{
+				NewStatus = 206;
+				NewRemaining = Last - First + 1;
+			}
+		}
+	}
+
+	{
+		base::AutoLock Scope(Lock);
+		Stream = NewStream;
+		Hash = NewHash;
+		Length = NewLength;
+		Status = NewStatus;
+		RangeFirst = First;
+		RangeLast = Last;
+		Remaining = NewRemaining;
+		EndOfStream = (Status == 304) || (Status == 404) || (Status == 416) || (Remaining == 0);
+
+		if (Cancelled)
+		{
+			return;
+		}
+	}
+
+	InCallback->Continue();
+}
+
+void FileResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response, int64& response_length, CefString& redirectUrl)
+{
+	base::AutoLock Scope(Lock);
+
+	response->SetStatus(Status);
+
+	if (Status == 404)
+	{
+		response->SetStatusText("Not Found");
+		response_length = 0;
+		return;
+	}
+
+	CefResponse::HeaderMap Headers;
+	Headers.insert(std::make_pair("Accept-Ranges", "bytes"));
+
+	if (!Hash.empty())
+	{
+		// the hash changes with the contents, so the cached copy never needs revalidating.
+		Headers.insert(std::make_pair("Cache-Control", "public, max-age=31536000, immutable"));
+		Headers.insert(std::make_pair("ETag", "\"" + Hash + "\""));
+	}
+
+	if (Status == 304)
+	{
+		response->SetStatusText("Not Modified");
+		response->SetMimeType(MimeType);
+		response->SetHeaderMap(Headers);
+		response_length = 0;
+		return;
+	}
+
+	if (Status == 416)
+	{
+		response->SetStatusText("Range Not Satisfiable");
+		Headers.insert(std::make_pair("Content-Range", "bytes */" + std::to_string(Length)));
+		response->SetHeaderMap(Headers);
+		response_length = 0;
+		return;
+	}
+
+	if (Status == 206)
+	{
+		response->SetStatusText("Partial Content");
+		Headers.insert(std::make_pair("Content-Range", "bytes " + std::to_string(RangeFirst) + "-" + std::to_string(RangeLast) + "/" + std::to_string(Length)));
+	}
+	else
+	{
+		response->SetStatusText("OK");
+	}
+
+	response->SetMimeType(MimeType);
+	response->SetHeaderMap(Headers);
+	response_length = Remaining;
+}
+
+bool FileResourceHandler::ReadResponse(void* data_out, int bytes_to_read, int& bytes_read, CefRefPtr<CefCallback> callback)
+{
+	REQUIRE_IO_THREAD()
+
+	bytes_read = 0;
+
+	{
+		base::AutoLock Scope(Lock);
+
+		if (Cancelled)
+		{
+			return false;
+		}
+
+		if (BufferOffset < Buffer.size())
+		{
+			const size_t Count = std::min((size_t)bytes_to_read, Buffer.size() - BufferOffset);
+			memcpy(data_out, &Buffer[BufferOffset], Count);
+			BufferOffset += Count;
+			bytes_read = (int)Count;
+			return true;
+		}
+
+		if (EndOfStream)
+		{
+			return false;
+		}
+	}
+
+	// nothing buffered, read ahead on a worker and have CEF call back in.
+	CefRefPtr<FileResourceHandler> Self(this);
+	FileWorkers::Post([Self, bytes_to_read, callback]()
+	{
+		Self->ReadAhead(bytes_to_read, callback);
+	});
+
+	return true;
+}
+
+void FileResourceHandler::ReadAhead(int InBytes, CefRefPtr<CefCallback> InCallback)
+{
+	int64 Limit;
+	{
+		base::AutoLock Scope(Lock);
+		if (Cancelled)
+		{
+			return;
+		}
+
+		Limit = Remaining;
+	}
+
+	// larger reads than CEF asks for halve the worker round trips on big files.
+	int ChunkSize = std::max(InBytes, 64 * 1024);
+	if (Limit >= 0)
+	{
+		// a range stops at its last byte.
+		ChunkSize = (int)std::min<int64>(ChunkSize, Limit);
+	}
+
+	std::vector<char> Chunk(std::max(ChunkSize, 1));
+	const int Count = (ChunkSize > 0) ? Stream->Read(&Chunk[0], ChunkSize) : 0;
+
+	{
+		base::AutoLock Scope(Lock);
+		Chunk.resize(std::max(Count, 0));
+		Buffer.swap(Chunk);
+		BufferOffset = 0;
+
+		if (Remaining >= 0)
+		{
+			Remaining -= Buffer.size();
+		}
+
+		EndOfStream = (Count <= 0) || (Remaining == 0) || Stream->IsEOF();
+
+		if (Cancelled)
+		{
+			return;
+		}
+	}
+
+	InCallback->Continue();
+}
+
+void FileResourceHandler::Cancel()
+{
+	base::AutoLock Scope(Lock);
+	Cancelled = true;
+	Buffer.clear();
+	BufferOffset = 0;
+}
@@ -0,0 +1,103 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#pragma once
+
+#include "include/cef_resource_handler.h"
+#include "include/base/cef_lock.h"
+
+#include "../API/CEFRuntimeAPI.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Custom scheme for game served content, registered standard so URLs have a host and path.
+#define RADUI_GAME_SCHEME "game"
+
+// game://<host>/<path>?<query>, OutPath keeps its leading '/'.
+bool ParseGameURL(const std::string& InURL, std::string& OutHost, std::string& OutPath, std::string& OutQuery);
+
+// MIME type served for a content:// path by extension, text/plain if unknown.
+std::string GetMimeType(const std::string& InPath);
+
+// Adds or replaces the MIME type for an extension (with or without the dot), see
+// ICefRuntimeAPI::RegisterMimeType.
+void RegisterMimeType(const std::string& InExtension, const std::string& InMimeType);
+
+// Streams an ICefDataStream as it is produced. ProcessRequest() waits for the game to
+// provide the headers, the response is sent without a length and ReadResponse() parks
+// the request until the stream reports more data. Not cached unless the stream says so.
+class DataStreamResourceHandler : public CefResourceHandler, public ICefDataStreamListener
+{
+	IMPLEMENT_REFCOUNTING(DataStreamResourceHandler);
+public:
+
+	explicit DataStreamResourceHandler(ICefDataStream* InStream);
+	~DataStreamResourceHandler();
+
+	virtual bool ProcessRequest(CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback) OVERRIDE;
+	virtual void GetResponseHeaders(CefRefPtr<CefResponse> response, int64& response_length, CefString& redirectUrl) OVERRIDE;
+	virtual bool ReadResponse(void* data_out, int bytes_to_read, int& bytes_read, CefRefPtr<CefCallback> callback) OVERRIDE;
+	virtual void Cancel() OVERRIDE;
+
+	virtual void DataAvailable() OVERRIDE;
+
+private:
+
+	void CloseStream();
+
+	base::Lock Lock;
+	ICefDataStream* Stream;
+	// request waiting on the stream, either for headers or data.
+	CefRefPtr<CefCallback> PendingRead;
+};
+
+// Serves a content:// file without touching the disk on the CEF IO thread. Opening the
+// ICefStream and every Read() run on FileWorkers, ProcessRequest() and ReadResponse()
+// return at once and continue the request when the worker is done. Single byte range
+// requests are answered with 206 Partial Content so media can seek. Files with a content
+// hash are cached by the browser as immutable and revalidated by ETag with 304s.
+class FileResourceHandler : public CefResourceHandler
+{
+	IMPLEMENT_REFCOUNTING(FileResourceHandler);
+public:
+
+	// Called on a worker, returns null if the file doesn't exist. OutHash is set when
+	// the contents are known never to change for this hash, e.g. bundled archive files.
+	typedef std::function<ICefStream*(std::string& OutHash)> FOpenFunc;
+
+	FileResourceHandler(const std::string& InMimeType, const FOpenFunc& InOpen);
+	~FileResourceHandler();
+
+	virtual bool ProcessRequest(CefRefPtr<CefRequest> request, CefRefPtr<CefCallback> callback) OVERRIDE;
+	virtual void GetResponseHeaders(CefRefPtr<CefResponse> response, int64& response_length, CefString& redirectUrl) OVERRIDE;
+	virtual bool ReadResponse(void* data_out, int bytes_to_read, int& bytes_read, CefRefPtr<CefCallback> callback) OVERRIDE;
+	virtual void Cancel() OVERRIDE;
+
+private:
+
+	void Open(CefRefPtr<CefCallback> InCallback);
+	void ReadAhead(int InBytes, CefRefPtr<CefCallback> InCallback);
+
+	std::string MimeType;
+	FOpenFunc OpenStream;
+	// If-None-Match from the request, then the opened file's hash.
+	std::string RequestETag;
+	std::string Hash;
+
+	// only touched by one worker at a time, requests never overlap.
+	ICefStream* Stream;
+
+	base::Lock Lock;
+	int64 Length;
+	// requested range, -1 where not given. Resolved against Length once open.
+	int64 RangeFirst;
+	int64 RangeLast;
+	// bytes left to send, -1 if the length is unknown.
+	int64 Remaining;
+	int Status;
+	std::vector<char> Buffer;
+	size_t BufferOffset;
+	bool EndOfStream;
+	bool Cancelled;
+};
@@ -0,0 +1,379 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#include "SharedState.hpp"
+#include "Assert.hpp"
+
+#include "include/cef_command_line.h"
+
+#include <stdio.h>
+
+std::string SharedStateLayout::GetMappingName(unsigned long InHostProcessId, int InBrowserId)
+{
+	char Name[64];
+	_snprintf_s(Name, sizeof(Name), _TRUNCATE, "Local\\RadiantUI.State.%lu.%d", InHostProcessId, InBrowserId);
+	return Name;
+}
+
+namespace
+{
+	inline SharedStateLayout::Header* GetHeader(unsigned char* InBlock)
+	{
+		return reinterpret_cast<SharedStateLayout::Header*>(InBlock);
+	}
+
+	inline SharedStateLayout::Field* GetFields(unsigned char* InBlock)
+	{
+		return reinterpret_cast<SharedStateLayout::Field*>(InBlock + sizeof(SharedStateLayout::Header));
+	}
+
+	unsigned int GetFieldSize(ICefSharedState::EFieldType InType, int InMaxLength)
+	{
+		switch (InType)
+		{
+		case ICefSharedState::Field_Int:
+			return sizeof(int);
+		case ICefSharedState::Field_Double:
+			return sizeof(double);
+		case ICefSharedState::Field_Bool:
+			return sizeof(int);
+		case ICefSharedState::Field_String:
+			return sizeof(unsigned int) + (unsigned int)((InMaxLength > 0) ? InMaxLength : 64);
+		}
+
+		return 0;
+	}
+
+	// pages can keep several targets per state, each remembers the write it last saw.
+	const char* SequenceKey = "__RadiantUISequence";
+}
+
+SharedStateWriter::SharedStateWriter() : Mapping(NULL), Block(nullptr), WriteDepth(0)
+{
+}
+
+SharedStateWriter::~SharedStateWriter()
+{
+	if (Block)
+	{
+		UnmapViewOfFile(Block);
+	}
+
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+	}
+}
+
+bool SharedStateWriter::Create(int InBrowserId)
+{
+	std::string Name = SharedStateLayout::GetMappingName(GetCurrentProcessId(), InBrowserId);
+
+	Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, SharedStateLayout::BlockSize, Name.c_str());
+	if (!Mapping)
+	{
+		return false;
+	}
+
+	Block = (unsigned char*)MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, SharedStateLayout::BlockSize);
+	if (!Block)
+	{
+		CloseHandle(Mapping);
+		Mapping = NULL;
+		return false;
+	}
+
+	// fresh mappings are zero filled.
+	return true;
+}
+
+int SharedStateWriter::FindField(const char* InName)
+{
+	SharedStateLayout::Header* Header = GetHeader(Block);
+	SharedStateLayout::Field* Fields = GetFields(Block);
+
+	for (unsigned int i = 0; i < Header->NumFields; ++i)
+	{
+		if (strncmp(Fields[i].Name, InName, SharedStateLayout::MaxNameLength) == 0)
+		{
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+int SharedStateWriter::AddField(const char* InName, EFieldType InType, int InMaxLength)
+{
+	if (!InName || (strlen(InName) >= SharedStateLayout::MaxNameLength))
+	{
+		return -1;
+	}
+
+	int Existing = FindField(InName);
+	if (Existing >= 0)
+	{
+		return (GetFields(Block)[Existing].Type == (unsigned int)InType) ? Existing : -1;
+	}
+
+	SharedStateLayout::Header* Header = GetHeader(Block);
+
+	const unsigned int Size = GetFieldSize(InType, InMaxLength);
+	const unsigned int Offset = (Header->DataSize + 7) & ~7u;
+
+	if ((Header->NumFields >= SharedStateLayout::MaxFields) || (SharedStateLayout::DataOffset + Offset + Size > SharedStateLayout::BlockSize))
+	{
+		return -1;
+	}
+
+	BeginWrite();
+
+	SharedStateLayout::Field& Field = GetFields(Block)[Header->NumFields];
+	strncpy_s(Field.Name, InName, _TRUNCATE);
+	Field.Type = (unsigned int)InType;
+	Field.Offset = Offset;
+	Field.Capacity = Size;
+
+	Header->DataSize = Offset + Size;
+	const int Index = (int)Header->NumFields++;
+
+	EndWrite();
+
+	return Index;
+}
+
+void SharedStateWriter::BeginWrite()
+{
+	if (WriteDepth++ == 0)
+	{
+		// odd: write in progress.
+		InterlockedIncrement(&GetHeader(Block)->Sequence);
+	}
+}
+
+void SharedStateWriter::EndWrite()
+{
+	ASSERT(WriteDepth > 0);
+
+	if (--WriteDepth == 0)
+	{
+		InterlockedIncrement(&GetHeader(Block)->Sequence);
+	}
+}
+
+void* SharedStateWriter::GetFieldData(int InField, EFieldType InType)
+{
+	ASSERT(WriteDepth > 0);
+
+	if ((InField < 0) || ((unsigned int)InField >= GetHeader(Block)->NumFields))
+	{
+		return nullptr;
+	}
+
+	SharedStateLayout::Field& Field = GetFields(Block)[InField];
+	if (Field.Type != (unsigned int)InType)
+	{
+		return nullptr;
+	}
+
+	return Block + SharedStateLayout::DataOffset + Field.Offset;
+}
+
+void SharedStateWriter::SetInt(int InField, int InValue)
+{
+	if (int* Data = (int*)GetFieldData(InField, Field_Int))
+	{
+		*Data = InValue;
+	}
+}
+
+void SharedStateWriter::SetDouble(int InField, double InValue)
+{
+	if (double* Data = (double*)GetFieldData(InField, Field_Double))
+	{
+		*Data = InValue;
+	}
+}
+
+void SharedStateWriter::SetBool(int InField, bool InValue)
+{
+	if (int* Data = (int*)GetFieldData(InField, Field_Bool))
+	{
+		*Data = InValue ? 1 : 0;
+	}
+}
+
+void SharedStateWriter::SetString(int InField, const char* InValue)
+{
+	if (unsigned char* Data = (unsigned char*)GetFieldData(InField, Field_String))
+	{
+		const unsigned int Capacity = GetFields(Block)[InField].Capacity - sizeof(unsigned int);
+
+		unsigned int Length = InValue ? (unsigned int)strlen(InValue) : 0;
+		if (Length > Capacity)
+		{
+			// don't cut a UTF-8 sequence in half.
+			Length = Capacity;
+			while ((Length > 0) && ((InValue[Length] & 0xC0) == 0x80))
+			{
+				--Length;
+			}
+		}
+
+		*(unsigned int*)Data = Length;
+		memcpy(Data + sizeof(unsigned int), InValue, Length);
+	}
+}
+
+SharedStateReader::SharedStateReader() : Mapping(NULL), Block(nullptr)
+{
+}
+
+SharedStateReader::~SharedStateReader()
+{
+	if (Block)
+	{
+		UnmapViewOfFile(Block);
+	}
+
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+	}
+}
+
+bool SharedStateReader::Open(int InBrowserId)
+{
+	CefString HostProcess = CefCommandLine::GetGlobalCommandLine()->GetSwitchValue(RADUI_SWITCH_HOSTPROCESS);
+	if (HostProcess.empty())
+	{
+		return false;
+	}
+
+	const unsigned long HostProcessId = strtoul(HostProcess.ToString().c_str(), nullptr, 10);
+	std::string Name = SharedStateLayout::GetMappingName(HostProcessId, InBrowserId);
+
+	Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, Name.c_str());
+	if (!Mapping)
+	{
+		return false;
+	}
+
+	Block = (const unsigned char*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, SharedStateLayout::BlockSize);
+	if (!Block)
+	{
+		CloseHandle(Mapping);
+		Mapping = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+bool SharedStateReader::Snapshot()
+{
+	const SharedStateLayout::Header* Header = reinterpret_cast<const SharedStateLayout::Header*>(Block);
+
+	const int MaxAttempts = 16;
+	for (int Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+	{
+		const LONG Sequence = Header->Sequence;
+		if (Sequence & 1)
+		{
+			YieldProcessor();
+			continue;
+		}
+
+		MemoryBarrier();
+
+		const unsigned int DataSize = Header->DataSize;
+		const unsigned int Size = SharedStateLayout::DataOffset + ((DataSize < SharedStateLayout::BlockSize - SharedStateLayout::DataOffset) ? DataSize : 0);
+		Copy.resize(Size);
+		memcpy(&Copy[0], Block, Size);
+
+		MemoryBarrier();
+
+		if (Header->Sequence == Sequence)
+		{
+			reinterpret_cast<SharedStateLayout::Header*>(&Copy[0])->Sequence = Sequence;
+			return true;
+		}
+	}
+
+	// the game is writing continuously, keep the previous values this frame.
+	return false;
+}
+
+CefRefPtr<CefV8Value> SharedStateReader::Read_RenderThread(CefRefPtr<CefV8Value> InTarget)
+{
+	REQUIRE_V8_CONTEXT()
+
+	CefRefPtr<CefV8Value> Target = (InTarget.get() && InTarget->IsObject()) ? InTarget : CefV8Value::CreateObject(nullptr);
+
+	const LONG Sequence = reinterpret_cast<const SharedStateLayout::Header*>(Block)->Sequence;
+	if (Target.get() == InTarget.get())
+	{
+		CefRefPtr<CefV8Value> LastSequence = Target->GetValue(SequenceKey);
+		if (LastSequence.get() && LastSequence->IsInt() && (LastSequence->GetIntValue() == (int)Sequence))
+		{
+			return Target;
+		}
+	}
+
+	if (!Snapshot())
+	{
+		return Target;
+	}
+
+	const SharedStateLayout::Header* Header = reinterpret_cast<const SharedStateLayout::Header*>(&Copy[0]);
+	const SharedStateLayout::Field* Fields = reinterpret_cast<const SharedStateLayout::Field*>(&Copy[0] + sizeof(SharedStateLayout::Header));
+	const unsigned char* Data = &Copy[0] + SharedStateLayout::DataOffset;
+
+	Target->SetValue(SequenceKey, CefV8Value::CreateInt((int)Header->Sequence), V8_PROPERTY_ATTRIBUTE_DONTENUM);
+
+	for (unsigned int i = 0; (i < Header->NumFields) && (i < SharedStateLayout::MaxFields); ++i)
+	{
+		const SharedStateLayout::Field& Field = Fields[i];
+		if (Field.Offset + Field.Capacity > Header->DataSize)
+		{
+			continue;
+		}
+
+		const unsigned char* FieldData = Data + Field.Offset;
+		std::string Name(Field.Name, strnlen(Field.Name, SharedStateLayout::MaxNameLength));
+
+		CefRefPtr<CefV8Value> Value;
+
+		switch (Field.Type)
+		{
+		case ICefSharedState::Field_Int:
+			Value = CefV8Value::CreateInt(*(const int*)FieldData);
+			break;
+		case ICefSharedState::Field_Double:
+			Value = CefV8Value::CreateDouble(*(const double*)FieldData);
+			break;
+		case ICefSharedState::Field_Bool:
+			Value = CefV8Value::CreateBool(*(const int*)FieldData != 0);
+			break;
+		case ICefSharedState::Field_String:
+			{
+				unsigned int Length = *(const unsigned int*)FieldData;
+				if (Length > Field.Capacity - sizeof(unsigned int))
+				{
+					Length = 0;
+				}
+
+				CefString String;
+				String.FromString(std::string((const char*)FieldData + sizeof(unsigned int), Length));
+				Value = CefV8Value::CreateString(String);
+			}
+			break;
+		}
+
+		if (Value.get())
+		{
+			Target->SetValue(Name, Value, V8_PROPERTY_ATTRIBUTE_NONE);
+		}
+	}
+
+	return Target;
+}
@@ -0,0 +1,107 @@
+// Copyright 2014 Joseph Riedel. All Rights Reserved.
+
+#pragma once
+
+#include "include/cef_app.h"
+#include "../API/CEFRuntimeAPI.hpp"
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+// Command line switch used to hand the browser process id to render processes,
+// which they need to find the shared state blocks of their browsers.
+#define RADUI_SWITCH_HOSTPROCESS "radiantui-host-process"
+
+// A shared state block is a file mapping per browser laid out as:
+//
+//	SharedStateHeader
+//	SharedStateField[MaxFields]
+//	field data
+//
+// The game writes fields between BeginWrite() and EndWrite(), which bump the
+// sequence number to odd and back to even (a seqlock). Readers copy the block and
+// retry if the sequence changed or was odd, so neither side ever blocks.
+namespace SharedStateLayout
+{
+	enum
+	{
+		MaxFields = 128,
+		MaxNameLength = 32,
+		BlockSize = 64 * 1024
+	};
+
+	struct Header
+	{
+		volatile LONG Sequence;
+		unsigned int NumFields;
+		unsigned int DataSize;
+		unsigned int Reserved;
+	};
+
+	struct Field
+	{
+		char Name[MaxNameLength];
+		unsigned int Type;
+		unsigned int Offset;
+		unsigned int Capacity;
+		unsigned int Reserved;
+	};
+
+	const unsigned int DataOffset = sizeof(Header) + sizeof(Field) * MaxFields;
+
+	std::string GetMappingName(unsigned long InHostProcessId, int InBrowserId);
+}
+
+// Browser process side, owned by the WebView.
+class SharedStateWriter : public ICefSharedState
+{
+public:
+
+	SharedStateWriter();
+	~SharedStateWriter();
+
+	bool Create(int InBrowserId);
+
+	virtual int AddField(const char* InName, EFieldType InType, int InMaxLength) OVERRIDE;
+	virtual int FindField(const char* InName) OVERRIDE;
+
+	virtual void BeginWrite() OVERRIDE;
+	virtual void SetInt(int InField, int InValue) OVERRIDE;
+	virtual void SetDouble(int InField, double InValue) OVERRIDE;
+	virtual void SetBool(int InField, bool InValue) OVERRIDE;
+	virtual void SetString(int InField, const char* InValue) OVERRIDE;
+	virtual void EndWrite() OVERRIDE;
+
+private:
+
+	void* GetFieldData(int InField, EFieldType InType);
+
+	HANDLE Mapping;
+	unsigned char* Block;
+	int WriteDepth;
+};
+
+// Render process side, one per browser.
+class SharedStateReader : public CefBase
+{
+	IMPLEMENT_REFCOUNTING(SharedStateReader);
+public:
+
+	SharedStateReader();
+	~SharedStateReader();
+
+	bool Open(int InBrowserId);
+
+	// Copies the fields into InTarget (or a new object if InTarget is not an object).
+	// Returns InTarget untouched if nothing was written since it was last filled.
+	CefRefPtr<CefV8Value> Read_RenderThread(CefRefPtr<CefV8Value> InTarget);
+
+private:
+
+	bool Snapshot();
+
+	HANDLE Mapping;
+	const unsigned char* Block;
+	std::vector<unsigned char> Copy;
+};
@@ -4,6 +4,7 @@
 #include "Variants.hpp"
 #include <vector>
 #include <map>
+#include <set>
 
 #define MAKE_BUILTIN_VARIANT(__Name, __Type) \
 class Var##__Name : public ICefRuntimeVariant##__Name/*, public CefBase*/ \
@@ -75,6 +76,9 @@ public:
 
 	static VarNull StaticInstance;
 
+	// the shared instance holds its own reference so it is never deleted.
+	VarNull() { AddRef(); }
+
 	virtual EVariantType GetType() { return TYPE_Null; }
 };
 
@@ -87,6 +91,9 @@ public:
 
 	static VarUndefined StaticInstance;
 
+	// the shared instance holds its own reference so it is never deleted.
+	VarUndefined() { AddRef(); }
+
 	virtual EVariantType GetType() { return TYPE_Undefined; }
 };
 
@@ -309,6 +316,248 @@ ICefRuntimeVariantFactory* GetStaticVariantFactory()
 	return &StaticInstance;
 }
 
+namespace
+{
+	// The V8 API in this CEF branch has no access to ArrayBuffer storage, so binary
+	// data crosses the extension boundary as a byte string (one UTF-16 unit per byte).
+	// The JS half of the shim lives in the extension script (see Application.cpp).
+	class V8BlobUserData : public CefBase
+	{
+		IMPLEMENT_REFCOUNTING(V8BlobUserData);
+	public:
+		CefRefPtr<CefBinaryValue> Value;
+
+		explicit V8BlobUserData(CefRefPtr<CefBinaryValue> InValue) : Value(InValue)
+		{
+			Live().insert(this);
+		}
+
+		virtual ~V8BlobUserData()
+		{
+			Live().erase(this);
+		}
+
+		// CefBase has no type query and the runtime is built without RTTI, so blobs
+		// are told apart from other user data by address. Render thread only.
+		static V8BlobUserData* Cast(CefBase* InUserData)
+		{
+			std::set<CefBase*>::const_iterator It = Live().find(InUserData);
+			return (It != Live().end()) ? static_cast<V8BlobUserData*>(*It) : nullptr;
+		}
+
+	private:
+
+		static std::set<CefBase*>& Live()
+		{
+			static std::set<CefBase*> StaticLive;
+			return StaticLive;
+		}
+	};
+
+	// OutValue is null for an empty blob, CefBinaryValue can't hold zero bytes.
+	bool GetV8Blob(CefRefPtr<CefV8Value> InValue, CefRefPtr<CefBinaryValue>& OutValue)
+	{
+		CefRefPtr<CefBase> UserData = InValue->GetUserData();
+		V8BlobUserData* Blob = UserData.get() ? V8BlobUserData::Cast(UserData.get()) : nullptr;
+		if (Blob)
+		{
+			OutValue = Blob->Value;
+			return true;
+		}
+
+		return false;
+	}
+
+	// for the same reason an empty blob crosses processes as a dictionary holding only this key.
+	const char* EmptyBlobKey = "\x01RadiantUI.EmptyBlob";
+
+	CefRefPtr<CefDictionaryValue> CreateEmptyBlob()
+	{
+		CefRefPtr<CefDictionaryValue> Dictionary = CefDictionaryValue::Create();
+		Dictionary->SetBool(EmptyBlobKey, true);
+		return Dictionary;
+	}
+
+	bool IsEmptyBlob(CefRefPtr<CefDictionaryValue> InDictionary)
+	{
+		return (InDictionary->GetSize() == 1) && InDictionary->HasKey(EmptyBlobKey);
+	}
+
+	// InValue is null for an empty ArrayBuffer.
+	CefRefPtr<CefV8Value> BinaryToV8ArrayBuffer_RenderThread(CefRefPtr<CefBinaryValue> InValue)
+	{
+		const size_t Size = InValue.get() ? InValue->GetSize() : 0;
+
+		std::vector<unsigned char> Bytes(Size);
+		std::vector<cef_char_t> Chars(Size);
+
+		if (Size > 0)
+		{
+			InValue->GetData(&Bytes[0], Size, 0);
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Chars[i] = Bytes[i];
+			}
+		}
+
+		CefString ByteString;
+		ByteString.FromString(Size > 0 ? &Chars[0] : nullptr, Size, true);
+
+		CefV8ValueList Arguments;
+		Arguments.push_back(CefV8Value::CreateString(ByteString));
+
+		CefRefPtr<CefV8Value> RadiantUI = CefV8Context::GetCurrentContext()->GetGlobal()->GetValue("RadiantUI");
+		if (RadiantUI.get() && RadiantUI->IsObject())
+		{
+			CefRefPtr<CefV8Value> MakeArrayBuffer = RadiantUI->GetValue("__MakeArrayBuffer");
+			if (MakeArrayBuffer.get() && MakeArrayBuffer->IsFunction())
+			{
+				return MakeArrayBuffer->ExecuteFunction(nullptr, Arguments);
+			}
+		}
+
+		// page replaced the RadiantUI object, hand back the raw byte string.
+		return Arguments[0];
+	}
+}
+
+CefRefPtr<CefV8Value> CreateV8Blob_RenderThread(const CefString& InBytes)
+{
+	REQUIRE_V8_CONTEXT()
+
+	const size_t Size = InBytes.length();
+	const cef_char_t* Chars = InBytes.c_str();
+
+	std::vector<unsigned char> Bytes(Size);
+	for (size_t i = 0; i < Size; ++i)
+	{
+		Bytes[i] = (unsigned char)Chars[i];
+	}
+
+	CefRefPtr<CefV8Value> Blob = CefV8Value::CreateObject(nullptr);
+	Blob->SetUserData(new V8BlobUserData(CefBinaryValue::Create(Size > 0 ? &Bytes[0] : nullptr, Size)));
+	return Blob;
+}
+
+namespace
+{
+	// objects and arrays nested deeper than this, or that contain themselves, are sent as null.
+	const size_t MaxV8Depth = 32;
+	typedef std::vector<CefRefPtr<CefV8Value> > V8Ancestors;
+
+	CefRefPtr<CefValue> V8ValueToValue(CefRefPtr<CefV8Value> InValue, V8Ancestors& InAncestors);
+
+	bool EnterV8Value(CefRefPtr<CefV8Value> InValue, V8Ancestors& InAncestors)
+	{
+		if (InAncestors.size() >= MaxV8Depth)
+		{
+			return false;
+		}
+
+		for (V8Ancestors::iterator it = InAncestors.begin(); it != InAncestors.end(); ++it)
+		{
+			if ((*it)->IsSame(InValue))
+			{
+				return false;
+			}
+		}
+
+		InAncestors.push_back(InValue);
+		return true;
+	}
+
+	CefRefPtr<CefListValue> V8ArrayToList(CefRefPtr<CefV8Value> InArray, V8Ancestors& InAncestors)
+	{
+		const int ArrayLength = InArray->GetArrayLength();
+
+		CefRefPtr<CefListValue> List = CefListValue::Create();
+		List->SetSize(ArrayLength);
+
+		for (int i = 0; i < ArrayLength; ++i)
+		{
+			List->SetValue(i, V8ValueToValue(InArray->GetValue(i), InAncestors));
+		}
+
+		return List;
+	}
+
+	CefRefPtr<CefDictionaryValue> V8ObjectToDictionary(CefRefPtr<CefV8Value> InObject, V8Ancestors& InAncestors)
+	{
+		std::vector<CefString> Keys;
+		InObject->GetKeys(Keys);
+
+		CefRefPtr<CefDictionaryValue> Dictionary = CefDictionaryValue::Create();
+
+		for (std::vector<CefString>::iterator it = Keys.begin(); it != Keys.end(); ++it)
+		{
+			CefRefPtr<CefV8Value> Value = InObject->GetValue(*it);
+			if (Value.get() && !Value->IsFunction())
+			{
+				Dictionary->SetValue(*it, V8ValueToValue(Value, InAncestors));
+			}
+		}
+
+		return Dictionary;
+	}
+
+	CefRefPtr<CefValue> V8ValueToValue(CefRefPtr<CefV8Value> InValue, V8Ancestors& InAncestors)
+	{
+		CefRefPtr<CefValue> Value = CefValue::Create();
+		CefRefPtr<CefBinaryValue> Binary;
+
+		if (InValue->IsBool())
+		{
+			Value->SetBool(InValue->GetBoolValue());
+		}
+		else if (InValue->IsInt())
+		{
+			Value->SetInt(InValue->GetIntValue());
+		}
+		else if (InValue->IsUInt())
+		{
+			Value->SetInt((int)InValue->GetUIntValue());
+		}
+		else if (InValue->IsDouble())
+		{
+			Value->SetDouble(InValue->GetDoubleValue());
+		}
+		else if (InValue->IsString())
+		{
+			Value->SetString(InValue->GetStringValue());
+		}
+		else if (InValue->IsObject() && GetV8Blob(InValue, Binary))
+		{
+			if (Binary.get())
+			{
+				Value->SetBinary(Binary);
+			}
+			else
+			{
+				Value->SetDictionary(CreateEmptyBlob());
+			}
+		}
+		else if ((InValue->IsArray() || (InValue->IsObject() && !InValue->IsFunction())) && EnterV8Value(InValue, InAncestors))
+		{
+			if (InValue->IsArray())
+			{
+				Value->SetList(V8ArrayToList(InValue, InAncestors));
+			}
+			else
+			{
+				Value->SetDictionary(V8ObjectToDictionary(InValue, InAncestors));
+			}
+
+			InAncestors.pop_back();
+		}
+		else
+		{
+			Value->SetNull();
+		}
+
+		return Value;
+	}
+}
+
 CefRefPtr<CefV8Value> ListToV8Array_RenderThread(CefRefPtr<CefListValue> InList)
 {
 	REQUIRE_V8_CONTEXT()
@@ -331,105 +580,159 @@ CefRefPtr<CefListValue> V8ArrayToList_RenderThread(CefRefPtr<CefV8Value> InArray
 	REQUIRE_V8_CONTEXT()
 	ASSERT(InArray.get() && InArray->IsValid());
 	
-	const int ArrayLength = InArray->GetArrayLength();
+	V8Ancestors Ancestors(1, InArray);
+	return V8ArrayToList(InArray, Ancestors);
+}
 
-	CefRefPtr<CefListValue> List = CefListValue::Create();
-	List->SetSize(ArrayLength);
+CefRefPtr<CefV8Value> DictionaryToV8Object_RenderThread(CefRefPtr<CefDictionaryValue> InDictionary)
+{
+	REQUIRE_V8_CONTEXT()
+	ASSERT(InDictionary.get() && InDictionary->IsValid());
 
-	for (int i = 0; i < ArrayLength; ++i)
+	if (IsEmptyBlob(InDictionary))
 	{
-		V8ValueToListItem_RenderThread(InArray->GetValue(i), List, i);
+		return BinaryToV8ArrayBuffer_RenderThread(nullptr);
 	}
 
-	return List;
+	CefDictionaryValue::KeyList Keys;
+	InDictionary->GetKeys(Keys);
+
+	CefRefPtr<CefV8Value> Object = CefV8Value::CreateObject(nullptr);
+
+	for (CefDictionaryValue::KeyList::iterator it = Keys.begin(); it != Keys.end(); ++it)
+	{
+		Object->SetValue(*it, ValueToV8Value_RenderThread(InDictionary->GetValue(*it)), V8_PROPERTY_ATTRIBUTE_NONE);
+	}
+
+	return Object;
 }
 
-CefRefPtr<CefV8Value> ListItemToV8Value_RenderThread(CefRefPtr<CefListValue> InList, int InIndex)
+CefRefPtr<CefDictionaryValue> V8ObjectToDictionary_RenderThread(CefRefPtr<CefV8Value> InObject)
+{
+	REQUIRE_V8_CONTEXT()
+	ASSERT(InObject.get() && InObject->IsValid());
+
+	V8Ancestors Ancestors(1, InObject);
+	return V8ObjectToDictionary(InObject, Ancestors);
+}
+
+CefRefPtr<CefV8Value> ValueToV8Value_RenderThread(CefRefPtr<CefValue> InValue)
 {
 	REQUIRE_V8_CONTEXT()
-	ASSERT(InList.get() && InList->IsValid());
 
-	switch (InList->GetType(InIndex))
+	switch (InValue->GetType())
 	{
 	case VTYPE_NULL:
 		return CefV8Value::CreateNull();
 	case VTYPE_BOOL:
-		return CefV8Value::CreateBool(InList->GetBool(InIndex));
+		return CefV8Value::CreateBool(InValue->GetBool());
 	case VTYPE_INT:
-		return CefV8Value::CreateInt(InList->GetInt(InIndex));
+		return CefV8Value::CreateInt(InValue->GetInt());
 	case VTYPE_DOUBLE:
-		return CefV8Value::CreateDouble(InList->GetDouble(InIndex));
+		return CefV8Value::CreateDouble(InValue->GetDouble());
 	case VTYPE_STRING:
-		return CefV8Value::CreateString(InList->GetString(InIndex));
+		return CefV8Value::CreateString(InValue->GetString());
 	case VTYPE_LIST:
-		return ListToV8Array_RenderThread(InList->GetList(InIndex));
+		return ListToV8Array_RenderThread(InValue->GetList());
+	case VTYPE_DICTIONARY:
+		return DictionaryToV8Object_RenderThread(InValue->GetDictionary());
+	case VTYPE_BINARY:
+		return BinaryToV8ArrayBuffer_RenderThread(InValue->GetBinary());
 	}
 
 	return nullptr;
 }
 
-void V8ValueToListItem_RenderThread(CefRefPtr<CefV8Value> InValue, CefRefPtr<CefListValue> InList, int InIndex)
+CefRefPtr<CefValue> V8ValueToValue_RenderThread(CefRefPtr<CefV8Value> InValue)
 {
 	REQUIRE_V8_CONTEXT()
 	ASSERT(InValue.get() && InValue->IsValid());
+
+	V8Ancestors Ancestors;
+	return V8ValueToValue(InValue, Ancestors);
+}
+
+CefRefPtr<CefV8Value> ListItemToV8Value_RenderThread(CefRefPtr<CefListValue> InList, int InIndex)
+{
+	REQUIRE_V8_CONTEXT()
 	ASSERT(InList.get() && InList->IsValid());
 
-	if (InValue->IsBool())
-	{
-		InList->SetBool(InIndex, InValue->GetBoolValue());
-	}
-	else if (InValue->IsInt())
-	{
-		InList->SetInt(InIndex, InValue->GetIntValue());
-	}
-	else if (InValue->IsUInt())
-	{
-		InList->SetInt(InIndex, (int)InValue->GetUIntValue());
-	}
-	else if (InValue->IsDouble())
-	{
-		InList->SetDouble(InIndex, InValue->GetDoubleValue());
-	}
-	else if (InValue->IsString())
-	{
-		InList->SetString(InIndex, InValue->GetStringValue());
-	}
-	else if (InValue->IsArray())
-	{
-		InList->SetList(InIndex, V8ArrayToList_RenderThread(InValue));
-	}
-	else
-	{
-		InList->SetNull(InIndex);
-	}
+	return ValueToV8Value_RenderThread(InList->GetValue(InIndex));
 }
 
-void SetCefListItemFromVariant(CefRefPtr<CefListValue> InList, int InIndex, ICefRuntimeVariant* InVariant)
+void V8ValueToListItem_RenderThread(CefRefPtr<CefV8Value> InValue, CefRefPtr<CefListValue> InList, int InIndex)
+{
+	REQUIRE_V8_CONTEXT()
+	ASSERT(InList.get() && InList->IsValid());
+
+	InList->SetValue(InIndex, V8ValueToValue_RenderThread(InValue));
+}
+
+CefRefPtr<CefValue> VariantToCefValue(ICefRuntimeVariant* InVariant)
 {
+	CefRefPtr<CefValue> Value = CefValue::Create();
+
 	switch (InVariant->GetType())
 	{
-	case ICefRuntimeVariant::TYPE_Undefined:
-		InList->SetNull(InIndex);
-		break;
-	case ICefRuntimeVariant::TYPE_Null:
-		InList->SetNull(InIndex);
-		break;
 	case ICefRuntimeVariant::TYPE_Int:
-		InList->SetInt(InIndex, static_cast<ICefRuntimeVariantInt*>(InVariant)->GetValue());
+		Value->SetInt(static_cast<ICefRuntimeVariantInt*>(InVariant)->GetValue());
 		break;
 	case ICefRuntimeVariant::TYPE_Double:
-		InList->SetDouble(InIndex, static_cast<ICefRuntimeVariantDouble*>(InVariant)->GetValue());
+		Value->SetDouble(static_cast<ICefRuntimeVariantDouble*>(InVariant)->GetValue());
 		break;
 	case ICefRuntimeVariant::TYPE_Bool:
-		InList->SetBool(InIndex, static_cast<ICefRuntimeVariantBool*>(InVariant)->GetValue());
+		Value->SetBool(static_cast<ICefRuntimeVariantBool*>(InVariant)->GetValue());
 		break;
 	case ICefRuntimeVariant::TYPE_String:
-		InList->SetString(InIndex, static_cast<ICefRuntimeVariantString*>(InVariant)->GetValue());
+		Value->SetString(static_cast<ICefRuntimeVariantString*>(InVariant)->GetValue());
 		break;
 	case ICefRuntimeVariant::TYPE_List:
-		InList->SetList(InIndex, VariantListToCefList(static_cast<ICefRuntimeVariantList*>(InVariant)));
+		Value->SetList(VariantListToCefList(static_cast<ICefRuntimeVariantList*>(InVariant)));
+		break;
+	case ICefRuntimeVariant::TYPE_Dictionary:
+		Value->SetDictionary(VariantDictionaryToCefDictionary(static_cast<ICefRuntimeVariantDictionary*>(InVariant)));
+		break;
+	case ICefRuntimeVariant::TYPE_Blob:
+		{
+			ICefRuntimeVariantBlob* Blob = static_cast<ICefRuntimeVariantBlob*>(InVariant);
+			if (Blob->GetSize() > 0)
+			{
+				Value->SetBinary(CefBinaryValue::Create(Blob->GetData(), Blob->GetSize()));
+			}
+			else
+			{
+				Value->SetDictionary(CreateEmptyBlob());
+			}
+		}
+		break;
+	default:
+		Value->SetNull();
 		break;
 	}
+
+	return Value;
+}
+
+CefRefPtr<CefDictionaryValue> VariantDictionaryToCefDictionary(ICefRuntimeVariantDictionary* InDictionary)
+{
+	CefRefPtr<CefDictionaryValue> Dictionary = CefDictionaryValue::Create();
+
+	ICefRuntimeVariantList* Keys = InDictionary->GetKeys();
+	const int NumKeys = Keys->GetSize();
+
+	for (int i = 0; i < NumKeys; ++i)
+	{
+		const char* Key = static_cast<ICefRuntimeVariantString*>(Keys->GetValue(i))->GetValue();
+		Dictionary->SetValue(Key, VariantToCefValue(InDictionary->GetValue(Key)));
+	}
+
+	Keys->Release();
+	return Dictionary;
+}
+
+void SetCefListItemFromVariant(CefRefPtr<CefListValue> InList, int InIndex, ICefRuntimeVariant* InVariant)
+{
+	InList->SetValue(InIndex, VariantToCefValue(InVariant));
 }
 
 CefRefPtr<CefListValue> VariantListToCefList(ICefRuntimeVariantList* InList)
@@ -482,6 +785,18 @@ ICefRuntimeVariantDictionary* CefDictionaryToVariant(CefRefPtr<CefDictionaryValu
 	return Dictionary;
 }
 
+ICefRuntimeVariant* CefDictionaryValueToVariant(CefRefPtr<CefDictionaryValue> InValue)
+{
+	ASSERT(InValue.get() && InValue->IsValid());
+
+	if (IsEmptyBlob(InValue))
+	{
+		return new VarBlob(nullptr, 0);
+	}
+
+	return CefDictionaryToVariant(InValue);
+}
+
 ICefRuntimeVariant* CefDictionaryKeyValueToVariant(CefRefPtr<CefDictionaryValue> InValue, const CefString& Key)
 {
 	CefValueType Type = InValue->GetType(Key);
@@ -503,7 +818,7 @@ ICefRuntimeVariant* CefDictionaryKeyValueToVariant(CefRefPtr<CefDictionaryValue>
 	case VTYPE_BINARY:
 		return CefBinaryToVariant(InValue->GetBinary(Key));
 	case VTYPE_DICTIONARY:
-		return CefDictionaryToVariant(InValue->GetDictionary(Key));
+		return CefDictionaryValueToVariant(InValue->GetDictionary(Key));
 	case VTYPE_LIST:
 		return CefListToVariant(InValue->GetList(Key));
 	}
@@ -548,7 +863,7 @@ ICefRuntimeVariant* CefListItemToVariant(CefRefPtr<CefListValue> InValue, int In
 	case VTYPE_BINARY:
 		return CefBinaryToVariant(InValue->GetBinary(InIndex));
 	case VTYPE_DICTIONARY:
-		return CefDictionaryToVariant(InValue->GetDictionary(InIndex));
+		return CefDictionaryValueToVariant(InValue->GetDictionary(InIndex));
 	case VTYPE_LIST:
 		return CefListToVariant(InValue->GetList(InIndex));
 	}
@@ -10,11 +10,20 @@ CefRefPtr<CefV8Value> ListToV8Array_RenderThread(CefRefPtr<CefListValue> InList)
 CefRefPtr<CefListValue> V8ArrayToList_RenderThread(CefRefPtr<CefV8Value> InArray);
 CefRefPtr<CefV8Value> ListItemToV8Value_RenderThread(CefRefPtr<CefListValue> InList, int InIndex);
 void V8ValueToListItem_RenderThread(CefRefPtr<CefV8Value> InValue, CefRefPtr<CefListValue> InList, int InIndex);
+CefRefPtr<CefV8Value> CreateV8Blob_RenderThread(const CefString& InBytes);
+CefRefPtr<CefV8Value> DictionaryToV8Object_RenderThread(CefRefPtr<CefDictionaryValue> InDictionary);
+CefRefPtr<CefDictionaryValue> V8ObjectToDictionary_RenderThread(CefRefPtr<CefV8Value> InObject);
+CefRefPtr<CefV8Value> ValueToV8Value_RenderThread(CefRefPtr<CefValue> InValue);
+CefRefPtr<CefValue> V8ValueToValue_RenderThread(CefRefPtr<CefV8Value> InValue);
 ICefRuntimeVariantBlob* CefBinaryToVariant(CefRefPtr<CefBinaryValue> InValue);
 ICefRuntimeVariantDictionary* CefDictionaryToVariant(CefRefPtr<CefDictionaryValue> InValue);
+// as CefDictionaryToVariant, but gives back an empty blob for the dictionary standing in for one.
+ICefRuntimeVariant* CefDictionaryValueToVariant(CefRefPtr<CefDictionaryValue> InValue);
 ICefRuntimeVariant* CefDictionaryKeyValueToVariant(CefRefPtr<CefDictionaryValue> InValue, const CefString& Key);
 ICefRuntimeVariantList* CefListToVariant(CefRefPtr<CefListValue> InValue);
 ICefRuntimeVariant* CefListItemToVariant(CefRefPtr<CefListValue> InValue, int InIndex);
+CefRefPtr<CefValue> VariantToCefValue(ICefRuntimeVariant* InVariant);
+CefRefPtr<CefDictionaryValue> VariantDictionaryToCefDictionary(ICefRuntimeVariantDictionary* InDictionary);
 void SetCefListItemFromVariant(CefRefPtr<CefListValue> InList, int InIndex, ICefRuntimeVariant* InVariant);
 CefRefPtr<CefListValue> VariantListToCefList(ICefRuntimeVariantList* InList);
 void SetCefListFromVariantList(CefRefPtr<CefListValue> InList, ICefRuntimeVariantList* InVariantList);
\ No newline at end of file
@@ -2,12 +2,22 @@
 
 #include "Variants.hpp"
 #include "WebView.hpp"
+#include "Application.hpp"
 
 ICefRuntimeVariantFactory* WebView::GetVariantFactory()
 {
 	return GetStaticVariantFactory();
 }
 
+WebView::WebView() : SharedState(nullptr)
+{
+}
+
+WebView::~WebView()
+{
+	delete SharedState;
+}
+
 void WebView::Bind(Handler* InClient)
 {
 	Client = InClient;
@@ -33,14 +43,96 @@ void WebView::SetMouseCursorChangeDisabled(bool InDisabled)
 
 void WebView::ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments)
 {
-	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(InHookName);
+	const bool Timed = Client->IsHookTimingEnabled();
+
+	CefRefPtr<CefProcessMessage> Message = Timed ? CefProcessMessage::Create(std::string(RADUIIPCMSG_TIMEDPREFIX) + InHookName) : CefProcessMessage::Create(InHookName);
 	if (InArguments)
 	{
 		SetCefListFromVariantList(Message->GetArgumentList(), InArguments);
 	}
+
+	if (Timed)
+	{
+		CefRefPtr<CefListValue> Arguments = Message->GetArgumentList();
+		Arguments->SetDouble(Arguments->GetSize(), CefRuntimeTimestamp());
+	}
+
+	Client->GetBrowser()->SendProcessMessage(PID_RENDERER, Message);
+}
+
+void WebView::SetHookTimingEnabled(bool InEnabled)
+{
+	Client->SetHookTimingEnabled(InEnabled);
+}
+
+void WebView::CompleteJSCall(int InCallId, ICefRuntimeVariant* InResult, const char* InError)
+{
+	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_CALLRESULT);
+	CefRefPtr<CefListValue> Result = Message->GetArgumentList();
+	Result->SetInt(0, InCallId);
+	Result->SetBool(1, InError == nullptr);
+
+	if (InError)
+	{
+		CefString Error;
+		Error.FromString(InError);
+		Result->SetString(2, Error);
+	}
+	else if (InResult)
+	{
+		Result->SetValue(2, VariantToCefValue(InResult));
+	}
+	else
+	{
+		Result->SetNull(2);
+	}
+
 	Client->GetBrowser()->SendProcessMessage(PID_RENDERER, Message);
 }
 
+void WebView::ExecuteScript(const char* InSource, ICefScriptCallback* InCallback)
+{
+	Client->ExecuteScript(0, InSource, InCallback);
+}
+
+int WebView::CompileScript(const char* InSource)
+{
+	return Client->CompileScript(InSource);
+}
+
+void WebView::ExecuteCompiledScript(int InScript, ICefScriptCallback* InCallback)
+{
+	Client->ExecuteScript(InScript, nullptr, InCallback);
+}
+
+void WebView::InsertFence(int InSequence)
+{
+	CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create(RADUIIPCMSG_FENCE);
+	Message->GetArgumentList()->SetInt(0, InSequence);
+	Client->GetBrowser()->SendProcessMessage(PID_RENDERER, Message);
+}
+
+ICefSharedState* WebView::GetSharedState()
+{
+	if (!SharedState && Client->GetBrowser().get())
+	{
+		SharedStateWriter* Writer = new SharedStateWriter();
+		if (Writer->Create(Client->GetBrowser()->GetIdentifier()))
+		{
+			SharedState = Writer;
+
+			// the page may already have looked for the block and given up.
+			Client->GetBrowser()->SendProcessMessage(PID_RENDERER, CefProcessMessage::Create(RADUIIPCMSG_SHAREDSTATE));
+		}
+		else
+		{
+			delete Writer;
+		}
+	}
+
+	return SharedState;
+}
+
 bool WebView::IsMouseCursorChangeDisabled()
 {
 	return Client->GetHost()->IsMouseCursorChangeDisabled();
@@ -6,11 +6,15 @@
 
 #include "../API/CEFRuntimeAPI.hpp"
 #include "Handler.hpp"
+#include "SharedState.hpp"
 
 class WebView : public ICefWebView
 {
 public:
 
+	WebView();
+	~WebView();
+
 	void Bind(Handler* InClient);
 
 	virtual ICefRuntimeVariantFactory* GetVariantFactory() OVERRIDE;
@@ -19,6 +23,16 @@ public:
 	virtual void LoadURL(const char *InURL);
 
 	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments);
+	virtual void CompleteJSCall(int InCallId, ICefRuntimeVariant* InResult, const char* InError);
+
+	virtual void ExecuteScript(const char* InSource, ICefScriptCallback* InCallback);
+	virtual int CompileScript(const char* InSource);
+	virtual void ExecuteCompiledScript(int InScript, ICefScriptCallback* InCallback);
+
+	virtual void InsertFence(int InSequence);
+	virtual void SetHookTimingEnabled(bool InEnabled);
+
+	virtual ICefSharedState* GetSharedState();
 
 	///
 	// Set whether mouse cursor change is disabled.
@@ -164,4 +178,5 @@ private:
 	cef_key_event_type_t Convert(ECefRuntimeKeyEvent InKeyState);
 
 	CefRefPtr<Handler> Client;
+	SharedStateWriter* SharedState;
 };
\ No newline at end of file
@@ -30,7 +30,7 @@ namespace
 //#define FRAMEWORKPATH "..\\..\\CefRuntime\\Binaries\\Release\\"DLLNAME
 #define FRAMEWORKPATH "Plugins\\RadiantUI\\CefRuntime\\Binaries\\Release\\"DLLNAME
 
-	static ICefRuntimeAPI* LoadCefFrameworkDLL(ICefRuntimeCallbacks *InCallbacks)
+	static ICefRuntimeAPI* LoadCefFrameworkDLL(ICefRuntimeCallbacks *InCallbacks, const CefRuntimeSettings& InSettings)
 	{
 		UE_LOG(RadiantUILog, Log, TEXT("Loading CEF Framework"));
 
@@ -97,13 +97,13 @@ namespace
 		}
 
 		CreateCefRuntimeAPI f = (CreateCefRuntimeAPI)GetProcAddress(Library, CEFCREATERUNTIMEAPI_SIG);
-		return f ? f(InCallbacks) : NULL;
+		return f ? f(InCallbacks, &InSettings) : NULL;
 	}
 #endif
 
 }
 
-ICefRuntimeAPI* CefStartup(ICefRuntimeCallbacks* InCallbacks)
+ICefRuntimeAPI* CefStartup(ICefRuntimeCallbacks* InCallbacks, const CefRuntimeSettings& InSettings)
 {
-	return LoadCefFrameworkDLL(InCallbacks);
+	return LoadCefFrameworkDLL(InCallbacks, InSettings);
 }
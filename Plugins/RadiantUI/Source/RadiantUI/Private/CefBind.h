@@ -6,4 +6,4 @@
 #include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
 #include "../../../CefRuntime/Source/DLLAPI.hpp"
 
-ICefRuntimeAPI* CefStartup(ICefRuntimeCallbacks* InCallbacks);
+ICefRuntimeAPI* CefStartup(ICefRuntimeCallbacks* InCallbacks, const CefRuntimeSettings& InSettings);
@@ -3,10 +3,107 @@
 
 #include "RadiantUIPrivatePCH.h"
 #include "JSCall.h"
+#include "RadiantHookBenchmark.h"
+#include "Engine/UserDefinedStruct.h"
 
 namespace
 {
-	ICefRuntimeVariant* TranslatePropertyHelper(UProperty* Property, void* Data, ICefRuntimeVariantFactory* VariantFactory)
+	struct FStructFieldLayout
+	{
+		UProperty* Property;
+		int32 Offset;
+		// UTF-8 field name, used as the dictionary key on the JavaScript side.
+		TArray<ANSICHAR> Key;
+	};
+
+	struct FStructLayout
+	{
+		TWeakObjectPtr<UStruct> Struct;
+		// what the layout was built from, a relinked struct no longer matches.
+		UProperty* PropertyLink;
+		int32 Size;
+		EFieldIteratorFlags::SuperClassFlags SuperFlags;
+		TArray<FStructFieldLayout> Fields;
+	};
+
+	// layouts are heap allocated so references stay valid while nested structs add entries.
+	// one map per SuperClassFlags value, a struct can be walked with and without its parents.
+	TMap<UStruct*, TSharedPtr<FStructLayout>> StructLayouts[2];
+
+	FString GetJavaScriptFieldName(UStruct* Struct, UProperty* Property)
+	{
+		FString Name = Property->GetName();
+
+		// Blueprint struct members are stored as <Name>_<Index>_<Guid>.
+		if (Struct->IsA<UUserDefinedStruct>())
+		{
+			int32 Separator;
+			for (int32 i = 0; (i < 2) && Name.FindLastChar(TEXT('_'), Separator); ++i)
+			{
+				Name = Name.Left(Separator);
+			}
+		}
+
+		return Name;
+	}
+
+	// Field layouts are built once per struct so marshaling is a linear walk over
+	// precomputed offsets and keys rather than a reflection query per field.
+	const FStructLayout& GetStructLayout(UStruct* Struct, EFieldIteratorFlags::SuperClassFlags SuperFlags)
+	{
+		check(IsInGameThread());
+
+		TMap<UStruct*, TSharedPtr<FStructLayout>>& Layouts = StructLayouts[(SuperFlags == EFieldIteratorFlags::IncludeSuper) ? 1 : 0];
+
+		// blueprint structs and classes are relinked in place when recompiled.
+		TSharedPtr<FStructLayout>* Existing = Layouts.Find(Struct);
+		if (Existing && (*Existing)->Struct.IsValid() && ((*Existing)->PropertyLink == Struct->PropertyLink) && ((*Existing)->Size == Struct->GetStructureSize()))
+		{
+			return **Existing;
+		}
+
+		TSharedPtr<FStructLayout> Layout = MakeShareable(new FStructLayout());
+		Layouts.Add(Struct, Layout);
+		Layout->Struct = Struct;
+		Layout->PropertyLink = Struct->PropertyLink;
+		Layout->Size = Struct->GetStructureSize();
+		Layout->SuperFlags = SuperFlags;
+
+		for (TFieldIterator<UProperty> It(Struct, SuperFlags); It; ++It)
+		{
+			FStructFieldLayout& Field = Layout->Fields[Layout->Fields.AddDefaulted()];
+			Field.Property = *It;
+			Field.Offset = It->GetOffset_ForInternal();
+
+			FTCHARToUTF8 Convert(*GetJavaScriptFieldName(Struct, *It));
+			Field.Key.Append(Convert.Get(), Convert.Length() + 1);
+		}
+
+		return *Layout;
+	}
+
+	// Objects keyed by field name carry a struct's inherited fields. Classes only
+	// contribute their own, matching the parameter objects created by
+	// URadiantJavaScriptFunctionCall subclasses.
+	const FStructLayout& GetNamedStructLayout(UStruct* Struct)
+	{
+		return GetStructLayout(Struct, Struct->IsA<UClass>() ? EFieldIteratorFlags::ExcludeSuper : EFieldIteratorFlags::IncludeSuper);
+	}
+
+	// TArray<float> and TArray<uint8> cross the process boundary as a single blob
+	// (an ArrayBuffer on the JavaScript side) instead of one variant per element.
+	bool IsBlobArrayProperty(UArrayProperty* ArrayProperty)
+	{
+		if (ArrayProperty->Inner->IsA<UFloatProperty>())
+		{
+			return true;
+		}
+
+		UByteProperty* ByteProperty = Cast<UByteProperty>(ArrayProperty->Inner);
+		return ByteProperty && !ByteProperty->Enum;
+	}
+
+	ICefRuntimeVariant* TranslatePropertyHelper(UProperty* Property, void* Data, ICefRuntimeVariantFactory* VariantFactory, bool bNamedStructFields)
 	{
 		ICefRuntimeVariant* Variant = nullptr;
 
@@ -55,12 +152,23 @@ namespace
 		else if (UStructProperty* StructProperty = Cast<UStructProperty>(Property))
 		{
 			UScriptStruct* InnerStruct = StructProperty->Struct;
-			Variant = FJavaScriptHelper::CreateVariantList(InnerStruct, Data, VariantFactory);
+			if (bNamedStructFields)
+			{
+				Variant = FJavaScriptHelper::CreateVariantDictionary(InnerStruct, Data, VariantFactory);
+			}
+			else
+			{
+				Variant = FJavaScriptHelper::CreateVariantList(InnerStruct, Data, VariantFactory);
+			}
 		}
 		else if (UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Property))
 		{
 			FScriptArray* ScriptArray = ArrayProperty->GetPropertyValuePtr(Data);
-			if (ScriptArray->Num() > 0)
+			if (IsBlobArrayProperty(ArrayProperty))
+			{
+				Variant = VariantFactory->CreateBlob(ScriptArray->GetData(), ScriptArray->Num() * ArrayProperty->Inner->ElementSize);
+			}
+			else if (ScriptArray->Num() > 0)
 			{
 				ICefRuntimeVariantList *List = VariantFactory->CreateList(0);
 
@@ -68,7 +176,7 @@ namespace
 
 				for (int32 i = 0; i < ScriptArray->Num(); ++i)
 				{
-					ICefRuntimeVariant* Var = TranslatePropertyHelper(ArrayProperty->Inner, ArrayBase + (i*ArrayProperty->Inner->ElementSize), VariantFactory);
+					ICefRuntimeVariant* Var = TranslatePropertyHelper(ArrayProperty->Inner, ArrayBase + (i*ArrayProperty->Inner->ElementSize), VariantFactory, bNamedStructFields);
 					if (Var)
 					{
 						List->SetValue(List->GetSize(), Var);
@@ -171,20 +279,21 @@ namespace
 
 			if (UStructProperty* StructProperty = Cast<UStructProperty>(Argument))
 			{
-				UScriptStruct* InnerStruct = StructProperty->Struct;
+				const FStructLayout& Layout = GetStructLayout(StructProperty->Struct, EFieldIteratorFlags::IncludeSuper);
 				
 				void* StructContainer = StructProperty->ContainerPtrToValuePtr<void*>(Container);
 
-				int StructIndex = 0;
-				for (TFieldIterator<UProperty> It(InnerStruct); It; ++It, ++StructIndex)
+				for (int32 StructIndex = 0; StructIndex < Layout.Fields.Num(); ++StructIndex)
 				{
+					UProperty* Field = Layout.Fields[StructIndex].Property;
+
 					if (StructIndex >= VarList->GetSize())
 					{
-						UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' caller did not supply enough arguments for field '%s'."), *HookName, ArgumentIndex, *(*It)->GetPathName());
+						UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' argument %d caller did not supply enough arguments for field '%s'."), *HookName, ArgumentIndex, *Field->GetPathName());
 						return false;
 					}
 
-					if (!StoreFunctionParameter(HookName, StructContainer, *It, VarList->GetValue(StructIndex), ArgumentIndex))
+					if (!StoreFunctionParameter(HookName, StructContainer, Field, VarList->GetValue(StructIndex), ArgumentIndex))
 					{
 						return false;
 					}
@@ -223,6 +332,58 @@ namespace
 				TypeMismatch = true;
 			}
 		}
+		else if (Variant->IsDictionary())
+		{
+			ICefRuntimeVariantDictionary* VarDictionary = static_cast<ICefRuntimeVariantDictionary*>(Variant);
+
+			if (UStructProperty* StructProperty = Cast<UStructProperty>(Argument))
+			{
+				const FStructLayout& Layout = GetNamedStructLayout(StructProperty->Struct);
+
+				void* StructContainer = StructProperty->ContainerPtrToValuePtr<void*>(Container);
+
+				// fields missing from the object keep their default (zeroed) value.
+				for (const FStructFieldLayout& Field : Layout.Fields)
+				{
+					ICefRuntimeVariant* FieldVariant = VarDictionary->GetValue(Field.Key.GetData());
+					if (!FieldVariant || (FieldVariant->GetType() == ICefRuntimeVariant::TYPE_Null) || (FieldVariant->GetType() == ICefRuntimeVariant::TYPE_Undefined))
+					{
+						continue;
+					}
+
+					if (!StoreFunctionParameter(HookName, StructContainer, Field.Property, FieldVariant, ArgumentIndex))
+					{
+						return false;
+					}
+				}
+			}
+			else
+			{
+				TypeMismatch = true;
+			}
+		}
+		else if (Variant->IsBlob())
+		{
+			ICefRuntimeVariantBlob* VarBlob = static_cast<ICefRuntimeVariantBlob*>(Variant);
+
+			UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Argument);
+			if (ArrayProperty && IsBlobArrayProperty(ArrayProperty) && ((VarBlob->GetSize() % ArrayProperty->Inner->ElementSize) == 0))
+			{
+				FScriptArrayHelper ScriptArray(ArrayProperty, ArrayProperty->ContainerPtrToValuePtr<void*>(Container));
+				check(ScriptArray.Num() == 0);
+
+				const int32 NumElements = (int32)(VarBlob->GetSize() / ArrayProperty->Inner->ElementSize);
+				if (NumElements > 0)
+				{
+					ScriptArray.Resize(NumElements);
+					FMemory::Memcpy(ScriptArray.GetRawPtr(0), VarBlob->GetData(), VarBlob->GetSize());
+				}
+			}
+			else
+			{
+				TypeMismatch = true;
+			}
+		}
 		
 		if (TypeMismatch)
 		{
@@ -231,18 +392,266 @@ namespace
 
 		return !TypeMismatch;
 	}
+
+	struct FHookParameter;
+
+	typedef bool (*FHookParameterConverter)(const FString& HookName, void* Parms, const FHookParameter& Parameter, ICefRuntimeVariant* Variant, int ArgumentIndex);
+
+	struct FHookParameter
+	{
+		UProperty* Property;
+		int32 Offset;
+		FHookParameterConverter Convert;
+	};
+
+	// Resolved receiver function and per-parameter converters for a (class, hook) pair.
+	struct FHookOutput
+	{
+		UProperty* Property;
+		int32 Offset;
+		TArray<ANSICHAR> Key;
+	};
+
+	struct FHookPlan
+	{
+		TWeakObjectPtr<UFunction> Function;
+		TArray<FHookParameter> Parameters;
+		// RadiantUI.Call() only passes the parameters that aren't pure outputs.
+		TArray<FHookParameter> Inputs;
+		// return value and out parameters sent back to RadiantUI.Call().
+		TArray<FHookOutput> Outputs;
+		// parameters that need construction/destruction around ProcessEvent.
+		TArray<UProperty*> ConstructedParameters;
+		TArray<UProperty*> DestructedParameters;
+	};
+
+	struct FHookPlanKey
+	{
+		UClass* Class;
+		FName HookName;
+
+		bool operator==(const FHookPlanKey& Other) const
+		{
+			return (Class == Other.Class) && (HookName == Other.HookName);
+		}
+
+		friend uint32 GetTypeHash(const FHookPlanKey& Key)
+		{
+			return HashCombine(PointerHash(Key.Class), GetTypeHash(Key.HookName));
+		}
+	};
+
+	TMap<FHookPlanKey, TSharedPtr<FHookPlan>> HookPlans;
+
+	// Fast paths store the value directly when the variant already has the expected
+	// type, anything else goes through StoreFunctionParameter for conversion and errors.
+	bool ConvertGeneric(const FString& HookName, void* Parms, const FHookParameter& Parameter, ICefRuntimeVariant* Variant, int ArgumentIndex)
+	{
+		return StoreFunctionParameter(HookName, Parms, Parameter.Property, Variant, ArgumentIndex);
+	}
+
+	template <typename T, ICefRuntimeVariant::EVariantType VariantType, typename VariantClass>
+	bool ConvertNumeric(const FString& HookName, void* Parms, const FHookParameter& Parameter, ICefRuntimeVariant* Variant, int ArgumentIndex)
+	{
+		if (Variant->GetType() == VariantType)
+		{
+			*(T*)((uint8*)Parms + Parameter.Offset) = (T)static_cast<VariantClass*>(Variant)->GetValue();
+			return true;
+		}
+
+		return ConvertGeneric(HookName, Parms, Parameter, Variant, ArgumentIndex);
+	}
+
+	bool ConvertBool(const FString& HookName, void* Parms, const FHookParameter& Parameter, ICefRuntimeVariant* Variant, int ArgumentIndex)
+	{
+		if (Variant->IsBool())
+		{
+			static_cast<UBoolProperty*>(Parameter.Property)->SetPropertyValue((uint8*)Parms + Parameter.Offset, static_cast<ICefRuntimeVariantBool*>(Variant)->GetValue());
+			return true;
+		}
+
+		return ConvertGeneric(HookName, Parms, Parameter, Variant, ArgumentIndex);
+	}
+
+	bool ConvertString(const FString& HookName, void* Parms, const FHookParameter& Parameter, ICefRuntimeVariant* Variant, int ArgumentIndex)
+	{
+		if (Variant->IsString())
+		{
+			*(FString*)((uint8*)Parms + Parameter.Offset) = static_cast<ICefRuntimeVariantString*>(Variant)->GetValue();
+			return true;
+		}
+
+		return ConvertGeneric(HookName, Parms, Parameter, Variant, ArgumentIndex);
+	}
+
+	FHookParameterConverter GetParameterConverter(UProperty* Property)
+	{
+		if (Property->IsA<UIntProperty>())
+		{
+			return &ConvertNumeric<int32, ICefRuntimeVariant::TYPE_Int, ICefRuntimeVariantInt>;
+		}
+		else if (Property->IsA<UUInt32Property>())
+		{
+			return &ConvertNumeric<uint32, ICefRuntimeVariant::TYPE_Int, ICefRuntimeVariantInt>;
+		}
+		else if (Property->IsA<UByteProperty>())
+		{
+			return &ConvertNumeric<uint8, ICefRuntimeVariant::TYPE_Int, ICefRuntimeVariantInt>;
+		}
+		else if (Property->IsA<UFloatProperty>())
+		{
+			return &ConvertNumeric<float, ICefRuntimeVariant::TYPE_Double, ICefRuntimeVariantDouble>;
+		}
+		else if (Property->IsA<UDoubleProperty>())
+		{
+			return &ConvertNumeric<double, ICefRuntimeVariant::TYPE_Double, ICefRuntimeVariantDouble>;
+		}
+		else if (Property->IsA<UBoolProperty>())
+		{
+			return &ConvertBool;
+		}
+		else if (Property->IsA<UStrProperty>())
+		{
+			return &ConvertString;
+		}
+
+		return &ConvertGeneric;
+	}
+
+	TSharedPtr<const FHookPlan> GetHookPlan(UClass* Class, const FString& HookName)
+	{
+		check(IsInGameThread());
+
+		FHookPlanKey Key;
+		Key.Class = Class;
+		Key.HookName = FName(*HookName);
+
+		// hooks may be inherited, so the function only has to belong to Class or one of its
+		// supers. functions replaced by a blueprint recompile are moved out of their class,
+		// and reinstancing flushes the plans outright (see FJavaScriptHelper::FlushCaches).
+		TSharedPtr<FHookPlan>* Existing = HookPlans.Find(Key);
+		if (Existing && (*Existing)->Function.IsValid())
+		{
+			UClass* Owner = (*Existing)->Function->GetOuterUClass();
+			if (Owner && Class->IsChildOf(Owner))
+			{
+				return *Existing;
+			}
+		}
+
+		UFunction* Function = Class->FindFunctionByName(Key.HookName);
+		if (!Function)
+		{
+			HookPlans.Remove(Key);
+			return nullptr;
+		}
+
+		TSharedPtr<FHookPlan> Plan = MakeShareable(new FHookPlan());
+		HookPlans.Add(Key, Plan);
+		Plan->Function = Function;
+
+		for (TFieldIterator<UProperty> It(Function); It && (It->PropertyFlags & CPF_Parm); ++It)
+		{
+			if ((It->PropertyFlags & CPF_ReturnParm) == 0)
+			{
+				FHookParameter& Parameter = Plan->Parameters[Plan->Parameters.AddDefaulted()];
+				Parameter.Property = *It;
+				Parameter.Offset = It->GetOffset_ForInternal();
+				Parameter.Convert = GetParameterConverter(*It);
+
+				if ((It->PropertyFlags & (CPF_OutParm | CPF_ReferenceParm)) != CPF_OutParm)
+				{
+					Plan->Inputs.Add(Parameter);
+				}
+			}
+
+			// const references are flagged as out parameters but can't be written to.
+			if (It->HasAnyPropertyFlags(CPF_ReturnParm) || (It->HasAnyPropertyFlags(CPF_OutParm) && !It->HasAnyPropertyFlags(CPF_ConstParm)))
+			{
+				FHookOutput& Output = Plan->Outputs[Plan->Outputs.AddDefaulted()];
+				Output.Property = *It;
+				Output.Offset = It->GetOffset_ForInternal();
+
+				FTCHARToUTF8 Convert(*It->GetName());
+				Output.Key.Append(Convert.Get(), Convert.Length() + 1);
+			}
+
+			if (!It->HasAnyPropertyFlags(CPF_ZeroConstructor))
+			{
+				Plan->ConstructedParameters.Add(*It);
+			}
+
+			if (!It->HasAnyPropertyFlags(CPF_NoDestructor))
+			{
+				Plan->DestructedParameters.Add(*It);
+			}
+		}
+
+		return Plan;
+	}
+
+	void ForgetHookPlan(UClass* Class, const FString& HookName)
+	{
+		FHookPlanKey Key;
+		Key.Class = Class;
+		Key.HookName = FName(*HookName);
+		HookPlans.Remove(Key);
+	}
+}
+
+namespace
+{
+	// Converts Arguments into a parameter block, calls the function and hands the block to
+	// OnCalled before the parameters are destroyed. Returns false if an argument didn't convert.
+	template <typename CallbackType>
+	bool InvokeHookPlan(UObject* Receiver, const FHookPlan& Plan, const TArray<FHookParameter>& Parameters, const FString& HookName, ICefRuntimeVariantList* Arguments, CallbackType&& OnCalled)
+	{
+		UFunction* Function = Plan.Function.Get();
+
+		void* Parms = (uint8*)FMemory_Alloca(Function->ParmsSize);
+		FMemory::Memzero(Parms, Function->ParmsSize);
+
+		for (UProperty* Property : Plan.ConstructedParameters)
+		{
+			Property->InitializeValue_InContainer(Parms);
+		}
+
+		bool bConverted = true;
+		for (int32 ArgumentIndex = 0; ArgumentIndex < Parameters.Num(); ++ArgumentIndex)
+		{
+			const FHookParameter& Parameter = Parameters[ArgumentIndex];
+			if (!Parameter.Convert(HookName, Parms, Parameter, Arguments->GetValue(ArgumentIndex), ArgumentIndex))
+			{
+				bConverted = false;
+				break;
+			}
+		}
+
+		if (bConverted)
+		{
+			Receiver->ProcessEvent(Function, Parms);
+			OnCalled(Parms);
+		}
+
+		for (UProperty* Property : Plan.DestructedParameters)
+		{
+			Property->DestroyValue_InContainer(Parms);
+		}
+
+		return bConverted;
+	}
 }
 
 void FJavaScriptHelper::ExecuteHook(UObject* Receiver, const FString& HookName, ICefRuntimeVariantList* Arguments)
 {
-	UFunction* Function = Receiver->GetClass()->FindFunctionByName(*HookName);
-	if (!Function)
+	TSharedPtr<const FHookPlan> Plan = GetHookPlan(Receiver->GetClass(), HookName);
+	if (!Plan.IsValid())
 	{
 		UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' in class '%s' was not found"), *HookName, *Receiver->GetClass()->GetFullName());
 		return;
 	}
 
-	int ArgumentMismatch = -1;
+	UFunction* Function = Plan->Function.Get();
 
 	if (Arguments)
 	{
@@ -251,20 +660,8 @@ void FJavaScriptHelper::ExecuteHook(UObject* Receiver, const FString& HookName,
 			UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' on Object '%s' was called with the wrong number arguments! The called function(called from JS) desires %i arguments, but the defined(in this game) has %i arguments."), *HookName, *Receiver->GetPathName(), Arguments->GetSize(), Function->NumParms);
 			return;
 		}
-		
-		void* Parms = (uint8*)FMemory_Alloca(Function->ParmsSize);
-		FMemory::Memzero(Parms, Function->ParmsSize);
 
-		int ArgumentIndex = 0;
-		for (TFieldIterator<UProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It, ++ArgumentIndex)
-		{
-			if (!StoreFunctionParameter(HookName, Parms, *It, Arguments->GetValue(ArgumentIndex), ArgumentIndex))
-			{
-				return;
-			}
-		}
-
-		Receiver->ProcessEvent(Function, Parms);
+		InvokeHookPlan(Receiver, *Plan, Plan->Parameters, HookName, Arguments, [](void*) {});
 	}
 	else
 	{
@@ -274,27 +671,79 @@ void FJavaScriptHelper::ExecuteHook(UObject* Receiver, const FString& HookName,
 		}
 		else
 		{
-			ArgumentMismatch = 0;
+			UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' argument %d type mismatch"), *HookName, 0);
 		}
 	}
+}
 
-	if (ArgumentMismatch >= 0)
+ICefRuntimeVariant* FJavaScriptHelper::ExecuteCall(UObject* Receiver, const FString& HookName, ICefRuntimeVariantList* Arguments, ICefRuntimeVariantFactory* VariantFactory, FString& OutError)
+{
+	TSharedPtr<const FHookPlan> Plan = GetHookPlan(Receiver->GetClass(), HookName);
+	if (!Plan.IsValid())
 	{
-		UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' argument %d type mismatch"), *HookName, ArgumentMismatch);
+		OutError = FString::Printf(TEXT("'%s' is not a function of '%s'"), *HookName, *Receiver->GetClass()->GetName());
+		return nullptr;
 	}
+
+	const int32 NumArguments = Arguments ? Arguments->GetSize() : 0;
+	if (NumArguments != Plan->Inputs.Num())
+	{
+		OutError = FString::Printf(TEXT("'%s' takes %d arguments but was called with %d"), *HookName, Plan->Inputs.Num(), NumArguments);
+		return nullptr;
+	}
+
+	// a single output is returned as is, several are returned as an object keyed by parameter name.
+	ICefRuntimeVariant* Result = nullptr;
+	auto CollectOutputs = [&Plan, &Result, VariantFactory](void* Parms)
+	{
+		if (Plan->Outputs.Num() == 1)
+		{
+			const FHookOutput& Output = Plan->Outputs[0];
+			Result = TranslatePropertyHelper(Output.Property, (uint8*)Parms + Output.Offset, VariantFactory, true);
+		}
+		else if (Plan->Outputs.Num() > 1)
+		{
+			ICefRuntimeVariantDictionary* Dictionary = VariantFactory->CreateDictionary();
+			for (const FHookOutput& Output : Plan->Outputs)
+			{
+				ICefRuntimeVariant* Variant = TranslatePropertyHelper(Output.Property, (uint8*)Parms + Output.Offset, VariantFactory, true);
+				if (Variant)
+				{
+					Dictionary->SetValue(Output.Key.GetData(), Variant);
+					Variant->Release();
+				}
+			}
+			Result = Dictionary;
+		}
+	};
+
+	if (!InvokeHookPlan(Receiver, *Plan, Plan->Inputs, HookName, Arguments, CollectOutputs))
+	{
+		OutError = FString::Printf(TEXT("'%s' was called with arguments of the wrong type"), *HookName);
+		return nullptr;
+	}
+
+	return Result ? Result : VariantFactory->CreateNull();
+}
+
+void FJavaScriptHelper::FlushCaches()
+{
+	HookPlans.Empty();
+	StructLayouts[0].Empty();
+	StructLayouts[1].Empty();
 }
 
-ICefRuntimeVariantList* FJavaScriptHelper::CreateVariantList(UStruct* Class, void* Container, ICefRuntimeVariantFactory* VariantFactory)
+ICefRuntimeVariantList* FJavaScriptHelper::CreateVariantList(UStruct* Class, void* Container, ICefRuntimeVariantFactory* VariantFactory, bool bNamedStructFields)
 {
 	if (VariantFactory)
 	{
 		ICefRuntimeVariantList* List = VariantFactory->CreateList(0);
 
-		for (TFieldIterator<UProperty> It(Class, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+		// positional lists have only ever carried the struct's own fields.
+		const FStructLayout& Layout = GetStructLayout(Class, EFieldIteratorFlags::ExcludeSuper);
+		for (const FStructFieldLayout& Field : Layout.Fields)
 		{
-			UProperty *Property = *It;
-
-			ICefRuntimeVariant* Variant = TranslatePropertyHelper(Property, Property->ContainerPtrToValuePtr<void*>(Container, 0), VariantFactory);
+			ICefRuntimeVariant* Variant = TranslatePropertyHelper(Field.Property, (uint8*)Container + Field.Offset, VariantFactory, bNamedStructFields);
 			if (Variant)
 			{
 				List->SetValue(List->GetSize(), Variant);
@@ -312,3 +761,129 @@ ICefRuntimeVariantList* FJavaScriptHelper::CreateVariantList(UStruct* Class, voi
 	
 	return nullptr;
 }
+
+ICefRuntimeVariantDictionary* FJavaScriptHelper::CreateVariantDictionary(UStruct* Class, void* Container, ICefRuntimeVariantFactory* VariantFactory)
+{
+	if (VariantFactory)
+	{
+		ICefRuntimeVariantDictionary* Dictionary = VariantFactory->CreateDictionary();
+
+		const FStructLayout& Layout = GetNamedStructLayout(Class);
+		for (const FStructFieldLayout& Field : Layout.Fields)
+		{
+			ICefRuntimeVariant* Variant = TranslatePropertyHelper(Field.Property, (uint8*)Container + Field.Offset, VariantFactory, true);
+			if (Variant)
+			{
+				Dictionary->SetValue(Field.Key.GetData(), Variant);
+				Variant->Release();
+			}
+		}
+
+		return Dictionary;
+	}
+
+	return nullptr;
+}
+
+ICefRuntimeVariant* FJavaScriptHelper::CreateVariant(UProperty* Property, void* Data, ICefRuntimeVariantFactory* VariantFactory, bool bNamedStructFields)
+{
+	return VariantFactory ? TranslatePropertyHelper(Property, Data, VariantFactory, bNamedStructFields) : nullptr;
+}
+
+bool FJavaScriptHelper::WantsNamedStructFields(UObject* Parameters)
+{
+	URadiantJavaScriptFunctionCall* FunctionCall = Cast<URadiantJavaScriptFunctionCall>(Parameters);
+	return FunctionCall && FunctionCall->bNamedStructFields;
+}
+
+namespace
+{
+	// Dispatches a hook repeatedly with default-valued arguments and reports the average cost.
+	// Point it at functions with empty bodies to measure marshaling and dispatch alone.
+	void RunHookBenchmark(UObject* Receiver, const FString& HookName, int32 Iterations)
+	{
+		UFunction* Function = Receiver->FindFunction(*HookName);
+		ICefRuntimeVariantFactory* VariantFactory = GetCefRuntime() ? GetCefRuntime()->GetVariantFactory() : nullptr;
+
+		if (!Function || !VariantFactory)
+		{
+			UE_LOG(RadiantUILog, Error, TEXT("RadiantUI.BenchmarkHook: could not resolve hook '%s' on '%s'."), *HookName, *Receiver->GetPathName());
+			return;
+		}
+
+		ICefRuntimeVariantList* Arguments = VariantFactory->CreateList(Function->NumParms, true);
+
+		uint8* Parms = (uint8*)FMemory_Alloca(Function->ParmsSize);
+		FMemory::Memzero(Parms, Function->ParmsSize);
+
+		int32 ArgumentIndex = 0;
+		for (TFieldIterator<UProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It, ++ArgumentIndex)
+		{
+			It->InitializeValue_InContainer(Parms);
+
+			ICefRuntimeVariant* Variant = TranslatePropertyHelper(*It, It->ContainerPtrToValuePtr<void>(Parms), VariantFactory, false);
+			if (Variant)
+			{
+				Arguments->SetValue(ArgumentIndex, Variant);
+			}
+
+			It->DestroyValue_InContainer(Parms);
+		}
+
+		// only this hook's plan is rebuilt, so the first call is timed cold without
+		// slowing down every other hook in a running game.
+		ForgetHookPlan(Receiver->GetClass(), HookName);
+
+		const double FirstCallStart = FPlatformTime::Seconds();
+		FJavaScriptHelper::ExecuteHook(Receiver, HookName, Arguments);
+		const double FirstCallTime = FPlatformTime::Seconds() - FirstCallStart;
+
+		const double Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			FJavaScriptHelper::ExecuteHook(Receiver, HookName, Arguments);
+		}
+		const double Time = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(RadiantUILog, Display, TEXT("RadiantUI.BenchmarkHook: '%s' (%d arguments) first call %.0f ns, %.1f ns per hook over %d calls."), *HookName, ArgumentIndex, FirstCallTime * 1e9, (Time * 1e9) / Iterations, Iterations);
+
+		Arguments->Release();
+	}
+
+	void BenchmarkHook(const TArray<FString>& Args)
+	{
+		// with no object the built in 0, 4 and 16 argument hooks are measured.
+		if ((Args.Num() < 2) && !((Args.Num() == 0) || Args[0].IsNumeric()))
+		{
+			UE_LOG(RadiantUILog, Display, TEXT("Usage: RadiantUI.BenchmarkHook [<ObjectPath> <HookName>] [Iterations]"));
+			return;
+		}
+
+		const int32 IterationsArg = (Args.Num() >= 2) ? 2 : 0;
+		const int32 Iterations = (Args.Num() > IterationsArg) ? FMath::Max(1, FCString::Atoi(*Args[IterationsArg])) : 10000;
+
+		if (Args.Num() < 2)
+		{
+			UObject* Fixture = GetMutableDefault<URadiantHookBenchmark>();
+			RunHookBenchmark(Fixture, TEXT("Hook0"), Iterations);
+			RunHookBenchmark(Fixture, TEXT("Hook4"), Iterations);
+			RunHookBenchmark(Fixture, TEXT("Hook16"), Iterations);
+			return;
+		}
+
+		UObject* Receiver = FindObject<UObject>(ANY_PACKAGE, *Args[0]);
+		if (!Receiver)
+		{
+			UE_LOG(RadiantUILog, Error, TEXT("RadiantUI.BenchmarkHook: could not find '%s'."), *Args[0]);
+			return;
+		}
+
+		RunHookBenchmark(Receiver, Args[1], Iterations);
+	}
+
+	FAutoConsoleCommand BenchmarkHookCommand(
+		TEXT("RadiantUI.BenchmarkHook"),
+		TEXT("Measures JavaScript hook dispatch cost. Usage: RadiantUI.BenchmarkHook [<ObjectPath> <HookName>] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkHook)
+	);
+}
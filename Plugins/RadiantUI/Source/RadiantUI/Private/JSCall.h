@@ -10,6 +10,16 @@ class FJavaScriptHelper
 public:
 
 	static void ExecuteHook(UObject* Receiver, const FString& HookName, ICefRuntimeVariantList* Arguments);
-	static ICefRuntimeVariantList* CreateVariantList(UStruct* Class, void *Container, ICefRuntimeVariantFactory* VariantFactory);
+
+	// Calls a function for RadiantUI.Call() and returns its result, or null with OutError set.
+	static ICefRuntimeVariant* ExecuteCall(UObject* Receiver, const FString& HookName, ICefRuntimeVariantList* Arguments, ICefRuntimeVariantFactory* VariantFactory, FString& OutError);
+	static ICefRuntimeVariantList* CreateVariantList(UStruct* Class, void *Container, ICefRuntimeVariantFactory* VariantFactory, bool bNamedStructFields = false);
+	static ICefRuntimeVariantDictionary* CreateVariantDictionary(UStruct* Class, void *Container, ICefRuntimeVariantFactory* VariantFactory);
+	static ICefRuntimeVariant* CreateVariant(UProperty* Property, void* Data, ICefRuntimeVariantFactory* VariantFactory, bool bNamedStructFields = true);
+	static bool WantsNamedStructFields(UObject* Parameters);
+
+	// Drops cached struct layouts and hook plans, called when classes are reloaded or
+	// blueprints are reinstanced.
+	static void FlushCaches();
 
 };
\ No newline at end of file
@@ -0,0 +1,254 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "RadiantContentCache.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Content cache hits"), STAT_RadiantUI_ContentCacheHits, STATGROUP_RadiantUI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Content cache misses"), STAT_RadiantUI_ContentCacheMisses, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Content cache hit rate (%)"), STAT_RadiantUI_ContentCacheHitRate, STATGROUP_RadiantUI);
+DECLARE_MEMORY_STAT(TEXT("Content cache bytes saved"), STAT_RadiantUI_ContentCacheSaved, STATGROUP_RadiantUI);
+DECLARE_MEMORY_STAT(TEXT("Content cache resident"), STAT_RadiantUI_ContentCacheResident, STATGROUP_RadiantUI);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarContentCacheSize(
+		TEXT("RadiantUI.ContentCacheSizeMB"),
+		32,
+		TEXT("Memory budget for cached content:// files, 0 disables the cache. Files over a quarter of the budget are never cached."));
+
+	void ContentCacheCommand(const TArray<FString>& Args)
+	{
+		FRadiantContentCache::Get().Dump();
+
+		if ((Args.Num() > 0) && (Args[0] == TEXT("flush")))
+		{
+			FRadiantContentCache::Get().Flush();
+		}
+	}
+
+	FAutoConsoleCommand ContentCacheConsoleCommand(
+		TEXT("RadiantUI.ContentCache"),
+		TEXT("Logs content:// cache hit rate and size. Usage: RadiantUI.ContentCache [flush]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ContentCacheCommand)
+	);
+}
+
+void FRadiantContentStream::Release()
+{
+	delete this;
+}
+
+int FRadiantContentStream::Read(void* Ptr, int Count)
+{
+	if (IsEOF())
+	{
+		return 0;
+	}
+
+	Count = FMath::Min(Count, Buffer->Num() - Ofs);
+	FMemory::Memcpy(Ptr, Buffer->GetData() + Ofs, Count);
+	Ofs += Count;
+	return Count;
+}
+
+bool FRadiantContentStream::Seek(int Offset, SeekType Whence)
+{
+	switch (Whence)
+	{
+	case ICefStream::Stream_Current:
+		Offset = Ofs + Offset;
+		break;
+	case ICefStream::Stream_End:
+		Offset = Buffer->Num() + Offset;
+		break;
+	case ICefStream::Stream_Set:
+		break;
+	}
+
+	if ((Offset >= 0) && (Offset <= Buffer->Num()))
+	{
+		Ofs = Offset;
+		return true;
+	}
+
+	return false;
+}
+
+FRadiantContentCache& FRadiantContentCache::Get()
+{
+	static FRadiantContentCache Instance;
+	return Instance;
+}
+
+FRadiantContentCache::FRadiantContentCache()
+: Head(nullptr)
+, Tail(nullptr)
+, ResidentBytes(0)
+, Hits(0)
+, Misses(0)
+, BytesSaved(0)
+, StatsFrame(0)
+{
+}
+
+FRadiantContentCache::~FRadiantContentCache()
+{
+	Flush();
+}
+
+void FRadiantContentCache::Link(FEntry* InEntry)
+{
+	InEntry->Prev = nullptr;
+	InEntry->Next = Head;
+
+	if (Head)
+	{
+		Head->Prev = InEntry;
+	}
+	else
+	{
+		Tail = InEntry;
+	}
+
+	Head = InEntry;
+}
+
+void FRadiantContentCache::Unlink(FEntry* InEntry)
+{
+	if (InEntry->Prev)
+	{
+		InEntry->Prev->Next = InEntry->Next;
+	}
+	else
+	{
+		Head = InEntry->Next;
+	}
+
+	if (InEntry->Next)
+	{
+		InEntry->Next->Prev = InEntry->Prev;
+	}
+	else
+	{
+		Tail = InEntry->Prev;
+	}
+}
+
+void FRadiantContentCache::Remove(FEntry* InEntry)
+{
+	Unlink(InEntry);
+	Entries.Remove(InEntry->Path);
+	ResidentBytes -= InEntry->Data->Num();
+	// streams still reading the buffer keep it alive.
+	delete InEntry;
+}
+
+void FRadiantContentCache::Trim(int64 InBudget)
+{
+	while (Tail && (ResidentBytes > InBudget))
+	{
+		Remove(Tail);
+	}
+}
+
+FRadiantContentBuffer FRadiantContentCache::Load(const FString& InPath, const FFileStatData& InStat)
+{
+	const int64 Budget = (int64)FMath::Max(CVarContentCacheSize.GetValueOnAnyThread(), 0) * 1024 * 1024;
+	{
+		FScopeLock L(&CriticalSection);
+
+		FEntry** Found = Entries.Find(InPath);
+		if (Found)
+		{
+			FEntry* Entry = *Found;
+			if ((Entry->ModificationTime == InStat.ModificationTime) && (Entry->FileSize == InStat.FileSize))
+			{
+				Unlink(Entry);
+				Link(Entry);
+
+				++Hits;
+				BytesSaved += Entry->Data->Num();
+				return Entry->Data;
+			}
+
+			// changed on disk.
+			Remove(Entry);
+		}
+
+		++Misses;
+	}
+
+	TArray<uint8>* Data = new TArray<uint8>();
+	if (!FFileHelper::LoadFileToArray(*Data, *InPath))
+	{
+		delete Data;
+		return FRadiantContentBuffer();
+	}
+
+	FRadiantContentBuffer Buffer = MakeShareable(Data);
+
+	if (Data->Num() > (Budget / 4))
+	{
+		// served uncached.
+		return Buffer;
+	}
+
+	FScopeLock L(&CriticalSection);
+
+	FEntry** Found = Entries.Find(InPath);
+	if (Found)
+	{
+		// another request loaded it first.
+		Remove(*Found);
+	}
+
+	FEntry* Entry = new FEntry();
+	Entry->Path = InPath;
+	Entry->Data = Buffer;
+	Entry->ModificationTime = InStat.ModificationTime;
+	Entry->FileSize = InStat.FileSize;
+	Entries.Add(InPath, Entry);
+	Link(Entry);
+	ResidentBytes += Data->Num();
+
+	Trim(Budget);
+
+	return Buffer;
+}
+
+void FRadiantContentCache::Flush()
+{
+	FScopeLock L(&CriticalSection);
+	Trim(-1);
+}
+
+void FRadiantContentCache::Dump()
+{
+	FScopeLock L(&CriticalSection);
+
+	const uint64 Lookups = Hits + Misses;
+	UE_LOG(RadiantUILog, Display, TEXT("RadiantUI content cache: %d files, %.2f MB resident (budget %d MB)"),
+		Entries.Num(), ResidentBytes / (1024.0 * 1024.0), CVarContentCacheSize.GetValueOnAnyThread());
+	UE_LOG(RadiantUILog, Display, TEXT("  %llu hits, %llu misses, %.1f%% hit rate, %.2f MB not re-read"),
+		Hits, Misses, (Lookups > 0) ? (100.0 * Hits / Lookups) : 0.0, BytesSaved / (1024.0 * 1024.0));
+}
+
+void FRadiantContentCache::UpdateStats()
+{
+	if (StatsFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	StatsFrame = GFrameCounter;
+
+	FScopeLock L(&CriticalSection);
+
+	const uint64 Lookups = Hits + Misses;
+	SET_DWORD_STAT(STAT_RadiantUI_ContentCacheHits, Hits);
+	SET_DWORD_STAT(STAT_RadiantUI_ContentCacheMisses, Misses);
+	SET_FLOAT_STAT(STAT_RadiantUI_ContentCacheHitRate, (Lookups > 0) ? (100.0 * Hits / Lookups) : 0.0);
+	SET_MEMORY_STAT(STAT_RadiantUI_ContentCacheSaved, BytesSaved);
+	SET_MEMORY_STAT(STAT_RadiantUI_ContentCacheResident, ResidentBytes);
+}
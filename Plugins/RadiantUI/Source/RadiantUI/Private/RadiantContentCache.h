@@ -0,0 +1,80 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
+
+typedef TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> FRadiantContentBuffer;
+
+// Read-only ICefStream over a buffer shared with the content cache.
+class FRadiantContentStream : public ICefStream
+{
+public:
+
+	explicit FRadiantContentStream(const FRadiantContentBuffer& InBuffer) : Buffer(InBuffer), Ofs(0) {}
+
+	virtual void Release() override;
+	virtual int Read(void* Ptr, int Count) override;
+	virtual bool Seek(int Offset, SeekType Whence) override;
+	virtual int GetPos() override { return Ofs; }
+	virtual bool IsEOF() override { return Ofs >= Buffer->Num(); }
+
+private:
+
+	FRadiantContentBuffer Buffer;
+	int32 Ofs;
+};
+
+// Process-wide LRU cache of content:// files, shared by every web view. Entries are
+// checked against the file's timestamp and size on every lookup so edited files are
+// picked up, and the total is bounded by RadiantUI.ContentCacheSizeMB. Thread-safe,
+// called from the CEF IO thread.
+class FRadiantContentCache
+{
+public:
+
+	static FRadiantContentCache& Get();
+
+	// Returns the file's contents, loading them on a miss. InStat is the file's current
+	// IFileManager::GetStatData(). Null if the file can't be read.
+	FRadiantContentBuffer Load(const FString& InPath, const FFileStatData& InStat);
+
+	void Flush();
+	void Dump();
+
+	// Publishes hit/miss counts to STATGROUP_RadiantUI, once per frame.
+	void UpdateStats();
+
+private:
+
+	struct FEntry
+	{
+		FString Path;
+		FRadiantContentBuffer Data;
+		FDateTime ModificationTime;
+		int64 FileSize;
+		// most recently used first.
+		FEntry* Prev;
+		FEntry* Next;
+	};
+
+	FRadiantContentCache();
+	~FRadiantContentCache();
+
+	void Link(FEntry* InEntry);
+	void Unlink(FEntry* InEntry);
+	void Remove(FEntry* InEntry);
+	void Trim(int64 InBudget);
+
+	FCriticalSection CriticalSection;
+	TMap<FString, FEntry*> Entries;
+	FEntry* Head;
+	FEntry* Tail;
+	int64 ResidentBytes;
+
+	uint64 Hits;
+	uint64 Misses;
+	uint64 BytesSaved;
+	uint64 StatsFrame;
+};
@@ -0,0 +1,191 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "RadiantDataStream.h"
+
+FString FRadiantApiRequest::GetBodyAsString() const
+{
+	FUTF8ToTCHAR Convert((const ANSICHAR*)Body.GetData(), Body.Num());
+	return FString(Convert.Length(), Convert.Get());
+}
+
+FRadiantDataStream::FRadiantDataStream(const FString& InChannel, const FString& InQuery, const FString& InMimeType)
+: Channel(InChannel)
+, Query(InQuery)
+, Status(200)
+, ReadOffset(0)
+, Listener(nullptr)
+, bListenerWaiting(false)
+, bHasHeaders(true)
+, bFinished(false)
+{
+	SetMimeType(InMimeType);
+}
+
+void FRadiantDataStream::SetMimeType(const FString& InMimeType)
+{
+	FTCHARToUTF8 Convert(*InMimeType);
+	MimeType.Reset();
+	MimeType.Append(Convert.Get(), Convert.Length() + 1);
+}
+
+void FRadiantDataStream::SetCacheControl(const FString& InCacheControl)
+{
+	FScopeLock L(&CriticalSection);
+
+	if (!bHasHeaders)
+	{
+		FTCHARToUTF8 Convert(*InCacheControl);
+		CacheControl.Reset();
+		CacheControl.Append(Convert.Get(), Convert.Length() + 1);
+	}
+}
+
+void FRadiantDataStream::Respond(int32 InStatus, const FString& InMimeType)
+{
+	FScopeLock L(&CriticalSection);
+
+	if (bHasHeaders)
+	{
+		return;
+	}
+
+	Status = InStatus;
+	SetMimeType(InMimeType);
+	bHasHeaders = true;
+	NotifyListener();
+}
+
+void FRadiantDataStream::Respond(int32 InStatus, const FString& InMimeType, const FString& InBody)
+{
+	Respond(InStatus, InMimeType);
+	Write(InBody);
+	Finish();
+}
+
+void FRadiantDataStream::Write(const void* InData, int32 InSize)
+{
+	FScopeLock L(&CriticalSection);
+
+	if (bFinished || bCancelled || (InSize <= 0))
+	{
+		return;
+	}
+
+	bHasHeaders = true;
+	Buffer.Append((const uint8*)InData, InSize);
+	NotifyListener();
+}
+
+void FRadiantDataStream::Write(const FString& InText)
+{
+	FTCHARToUTF8 Convert(*InText);
+	Write(Convert.Get(), Convert.Length());
+}
+
+void FRadiantDataStream::Finish()
+{
+	FScopeLock L(&CriticalSection);
+
+	if (!bFinished)
+	{
+		bHasHeaders = true;
+		bFinished = true;
+		NotifyListener();
+	}
+}
+
+int32 FRadiantDataStream::GetBufferedSize()
+{
+	FScopeLock L(&CriticalSection);
+	return Buffer.Num() - ReadOffset;
+}
+
+void FRadiantDataStream::NotifyListener()
+{
+	// only wake the reader if it is parked waiting on us.
+	if (bListenerWaiting && Listener)
+	{
+		bListenerWaiting = false;
+		Listener->DataAvailable();
+	}
+}
+
+void FRadiantDataStream::Release()
+{
+	CefReference.Reset();
+}
+
+bool FRadiantDataStream::HasHeaders()
+{
+	FScopeLock L(&CriticalSection);
+
+	if (!bHasHeaders)
+	{
+		bListenerWaiting = true;
+	}
+
+	return bHasHeaders;
+}
+
+int FRadiantDataStream::GetStatus()
+{
+	FScopeLock L(&CriticalSection);
+	return Status;
+}
+
+const char* FRadiantDataStream::GetMimeType()
+{
+	// only read once the headers are final.
+	return MimeType.GetData();
+}
+
+const char* FRadiantDataStream::GetCacheControl()
+{
+	return (CacheControl.Num() > 0) ? CacheControl.GetData() : nullptr;
+}
+
+int FRadiantDataStream::Read(void* OutBuffer, int InMaxBytes)
+{
+	FScopeLock L(&CriticalSection);
+
+	const int32 Available = Buffer.Num() - ReadOffset;
+	if (Available > 0)
+	{
+		const int32 Count = FMath::Min(Available, InMaxBytes);
+		FMemory::Memcpy(OutBuffer, Buffer.GetData() + ReadOffset, Count);
+		ReadOffset += Count;
+
+		if (ReadOffset == Buffer.Num())
+		{
+			Buffer.Reset();
+			ReadOffset = 0;
+		}
+
+		return Count;
+	}
+
+	if (bFinished || bCancelled)
+	{
+		return -1;
+	}
+
+	bListenerWaiting = true;
+	return 0;
+}
+
+void FRadiantDataStream::SetListener(ICefDataStreamListener* InListener)
+{
+	FScopeLock L(&CriticalSection);
+	Listener = InListener;
+	bListenerWaiting = false;
+}
+
+void FRadiantDataStream::Cancel()
+{
+	FScopeLock L(&CriticalSection);
+	bCancelled = true;
+	Buffer.Empty();
+	ReadOffset = 0;
+}
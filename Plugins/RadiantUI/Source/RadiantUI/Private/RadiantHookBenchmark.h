@@ -0,0 +1,29 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "RadiantHookBenchmark.generated.h"
+
+// Empty hooks RadiantUI.BenchmarkHook runs when no object is given, so dispatch and
+// marshaling cost can be compared across builds on the same 0, 4 and 16 argument shapes.
+UCLASS(Transient, NotBlueprintable)
+class URadiantHookBenchmark : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION()
+	void Hook0() {}
+
+	UFUNCTION()
+	void Hook4(int32 A, float B, bool C, const FString& D) {}
+
+	UFUNCTION()
+	void Hook16(
+		int32 A0, float B0, bool C0, const FString& D0,
+		int32 A1, float B1, bool C1, const FString& D1,
+		int32 A2, float B2, bool C2, const FString& D2,
+		int32 A3, float B3, bool C3, const FString& D3) {}
+};
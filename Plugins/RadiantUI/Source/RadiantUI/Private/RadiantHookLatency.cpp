@@ -0,0 +1,240 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "RadiantHookLatency.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Page to game p50 (ms)"), STAT_RadiantUI_PageToGameP50, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Page to game p99 (ms)"), STAT_RadiantUI_PageToGameP99, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Page to game max (ms)"), STAT_RadiantUI_PageToGameMax, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Game to page p50 (ms)"), STAT_RadiantUI_GameToPageP50, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Game to page p99 (ms)"), STAT_RadiantUI_GameToPageP99, STATGROUP_RadiantUI);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Game to page max (ms)"), STAT_RadiantUI_GameToPageMax, STATGROUP_RadiantUI);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarHookTiming(
+		TEXT("RadiantUI.HookTiming"),
+		0,
+		TEXT("Measures JavaScript hook latency per stage, see RadiantUI.DumpHookLatency and stat RadiantUI."));
+
+	const TCHAR* StageNames[ERadiantHookStage::Num] =
+	{
+		TEXT("page -> browser"),
+		TEXT("browser -> queue"),
+		TEXT("queued"),
+		TEXT("handler"),
+		TEXT("page -> game total"),
+		TEXT("browser -> page"),
+		TEXT("page handlers"),
+		TEXT("game -> page total")
+	};
+
+	void DumpHookLatency(const TArray<FString>& Args)
+	{
+		FRadiantHookLatency::Get().Dump();
+
+		if ((Args.Num() > 0) && (Args[0] == TEXT("reset")))
+		{
+			FRadiantHookLatency::Get().Reset();
+		}
+	}
+
+	FAutoConsoleCommand DumpHookLatencyCommand(
+		TEXT("RadiantUI.DumpHookLatency"),
+		TEXT("Logs per-hook JavaScript bridge latency collected while RadiantUI.HookTiming is set. Usage: RadiantUI.DumpHookLatency [reset]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&DumpHookLatency)
+	);
+}
+
+FRadiantLatencyHistogram::FRadiantLatencyHistogram()
+{
+	Reset();
+}
+
+void FRadiantLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Counts, sizeof(Counts));
+	Count = 0;
+	MaxMicroseconds = 0;
+}
+
+int32 FRadiantLatencyHistogram::GetBucket(uint64 InMicroseconds)
+{
+	if (InMicroseconds < LinearBuckets)
+	{
+		return (int32)InMicroseconds;
+	}
+
+	const uint32 HighBit = FMath::Min((uint32)FPlatformMath::FloorLog2_64(InMicroseconds), (uint32)MaxBits - 1);
+	const uint32 Shift = HighBit - SubBucketBits;
+	const uint64 SubBucket = FMath::Min(InMicroseconds >> Shift, (uint64)(2 * SubBuckets - 1)) - SubBuckets;
+
+	return LinearBuckets + (HighBit - SubBucketBits - 1) * SubBuckets + (int32)SubBucket;
+}
+
+uint64 FRadiantLatencyHistogram::GetBucketValue(int32 InBucket)
+{
+	if (InBucket < LinearBuckets)
+	{
+		return InBucket;
+	}
+
+	const int32 Group = (InBucket - LinearBuckets) / SubBuckets;
+	const uint64 SubBucket = (InBucket - LinearBuckets) % SubBuckets + SubBuckets;
+	const uint32 Shift = Group + 1;
+
+	// middle of the bucket.
+	return (SubBucket << Shift) + ((1ull << Shift) >> 1);
+}
+
+void FRadiantLatencyHistogram::Record(double InSeconds)
+{
+	const uint64 Microseconds = (uint64)FMath::Max(InSeconds * 1e6, 0.0);
+	++Counts[GetBucket(Microseconds)];
+	++Count;
+	MaxMicroseconds = FMath::Max(MaxMicroseconds, Microseconds);
+}
+
+void FRadiantLatencyHistogram::Merge(const FRadiantLatencyHistogram& InOther)
+{
+	for (int32 i = 0; i < NumBuckets; ++i)
+	{
+		Counts[i] += InOther.Counts[i];
+	}
+
+	Count += InOther.Count;
+	MaxMicroseconds = FMath::Max(MaxMicroseconds, InOther.MaxMicroseconds);
+}
+
+double FRadiantLatencyHistogram::GetPercentile(double InPercentile) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const uint64 Target = FMath::Max<uint64>(1, (uint64)FMath::CeilToDouble(Count * FMath::Clamp(InPercentile, 0.0, 100.0) / 100.0));
+	uint64 Seen = 0;
+
+	for (int32 i = 0; i < NumBuckets; ++i)
+	{
+		Seen += Counts[i];
+		if (Seen >= Target)
+		{
+			return FMath::Min(GetBucketValue(i), MaxMicroseconds) * 1e-6;
+		}
+	}
+
+	return GetMax();
+}
+
+FRadiantHookLatency& FRadiantHookLatency::Get()
+{
+	static FRadiantHookLatency Instance;
+	return Instance;
+}
+
+bool FRadiantHookLatency::IsEnabled()
+{
+	return CVarHookTiming.GetValueOnGameThread() != 0;
+}
+
+void FRadiantHookLatency::Record(const FString& InHookName, ERadiantHookStage::Type InStage, double InSeconds)
+{
+	TSharedPtr<FHookHistograms>& Hook = Hooks.FindOrAdd(InHookName);
+	if (!Hook.IsValid())
+	{
+		Hook = MakeShareable(new FHookHistograms());
+	}
+
+	Hook->Stages[InStage].Record(InSeconds);
+	Totals.Stages[InStage].Record(InSeconds);
+}
+
+void FRadiantHookLatency::RecordPageToGame(const FString& InHookName, const CefRuntimeHookTiming& InTiming, double InQueuedTime, double InDispatchTime, double InHandledTime)
+{
+	FScopeLock L(&CriticalSection);
+
+	Record(InHookName, ERadiantHookStage::PageToBrowser, InTiming.BrowserTime - InTiming.PageTime);
+	Record(InHookName, ERadiantHookStage::BrowserToQueue, InQueuedTime - InTiming.BrowserTime);
+	Record(InHookName, ERadiantHookStage::Queued, InDispatchTime - InQueuedTime);
+	Record(InHookName, ERadiantHookStage::Handler, InHandledTime - InDispatchTime);
+	Record(InHookName, ERadiantHookStage::PageToGame, InHandledTime - InTiming.PageTime);
+}
+
+void FRadiantHookLatency::RecordGameToPage(const FString& InHookName, const CefRuntimeHookTiming& InTiming)
+{
+	FScopeLock L(&CriticalSection);
+
+	Record(InHookName, ERadiantHookStage::BrowserToPage, InTiming.PageTime - InTiming.BrowserTime);
+	Record(InHookName, ERadiantHookStage::PageHandlers, InTiming.PageHandledTime - InTiming.PageTime);
+	Record(InHookName, ERadiantHookStage::GameToPage, InTiming.PageHandledTime - InTiming.BrowserTime);
+}
+
+void FRadiantHookLatency::UpdateStats()
+{
+	if (StatsFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	StatsFrame = GFrameCounter;
+
+	FScopeLock L(&CriticalSection);
+
+	const FRadiantLatencyHistogram& PageToGame = Totals.Stages[ERadiantHookStage::PageToGame];
+	const FRadiantLatencyHistogram& GameToPage = Totals.Stages[ERadiantHookStage::GameToPage];
+
+	SET_FLOAT_STAT(STAT_RadiantUI_PageToGameP50, PageToGame.GetPercentile(50.0) * 1000.0);
+	SET_FLOAT_STAT(STAT_RadiantUI_PageToGameP99, PageToGame.GetPercentile(99.0) * 1000.0);
+	SET_FLOAT_STAT(STAT_RadiantUI_PageToGameMax, PageToGame.GetMax() * 1000.0);
+	SET_FLOAT_STAT(STAT_RadiantUI_GameToPageP50, GameToPage.GetPercentile(50.0) * 1000.0);
+	SET_FLOAT_STAT(STAT_RadiantUI_GameToPageP99, GameToPage.GetPercentile(99.0) * 1000.0);
+	SET_FLOAT_STAT(STAT_RadiantUI_GameToPageMax, GameToPage.GetMax() * 1000.0);
+}
+
+void FRadiantHookLatency::Dump()
+{
+	FScopeLock L(&CriticalSection);
+
+	if (Hooks.Num() == 0)
+	{
+		UE_LOG(RadiantUILog, Display, TEXT("RadiantUI.DumpHookLatency: nothing recorded, set RadiantUI.HookTiming 1 first."));
+		return;
+	}
+
+	auto DumpHistograms = [](const FString& InName, const FHookHistograms& InHistograms)
+	{
+		UE_LOG(RadiantUILog, Display, TEXT("%s"), *InName);
+
+		for (int32 Stage = 0; Stage < ERadiantHookStage::Num; ++Stage)
+		{
+			const FRadiantLatencyHistogram& Histogram = InHistograms.Stages[Stage];
+			if (Histogram.GetCount() > 0)
+			{
+				UE_LOG(RadiantUILog, Display, TEXT("  %-20s %8llu calls  p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms"),
+					StageNames[Stage], Histogram.GetCount(), Histogram.GetPercentile(50.0) * 1000.0, Histogram.GetPercentile(99.0) * 1000.0, Histogram.GetMax() * 1000.0);
+			}
+		}
+	};
+
+	DumpHistograms(TEXT("All hooks"), Totals);
+
+	for (auto It = Hooks.CreateConstIterator(); It; ++It)
+	{
+		DumpHistograms(It.Key(), *It.Value());
+	}
+}
+
+void FRadiantHookLatency::Reset()
+{
+	FScopeLock L(&CriticalSection);
+
+	Hooks.Empty();
+
+	for (int32 Stage = 0; Stage < ERadiantHookStage::Num; ++Stage)
+	{
+		Totals.Stages[Stage].Reset();
+	}
+}
@@ -0,0 +1,96 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
+
+// Log-linear latency histogram (HdrHistogram style) with about 3% precision from 1 us to
+// over half an hour, in a fixed 3.5 KB.
+class FRadiantLatencyHistogram
+{
+public:
+
+	FRadiantLatencyHistogram();
+
+	void Record(double InSeconds);
+	void Merge(const FRadiantLatencyHistogram& InOther);
+	void Reset();
+
+	uint64 GetCount() const { return Count; }
+	// InPercentile is 0-100. Returns seconds.
+	double GetPercentile(double InPercentile) const;
+	double GetMax() const { return MaxMicroseconds * 1e-6; }
+
+private:
+
+	enum
+	{
+		SubBucketBits = 5,
+		SubBuckets = 1 << SubBucketBits,
+		// values below this are counted exactly.
+		LinearBuckets = 2 * SubBuckets,
+		MaxBits = 32,
+		NumBuckets = LinearBuckets + (MaxBits - SubBucketBits - 1) * SubBuckets
+	};
+
+	static int32 GetBucket(uint64 InMicroseconds);
+	static uint64 GetBucketValue(int32 InBucket);
+
+	uint32 Counts[NumBuckets];
+	uint64 Count;
+	uint64 MaxMicroseconds;
+};
+
+namespace ERadiantHookStage
+{
+	enum Type
+	{
+		// page to game
+		PageToBrowser,
+		BrowserToQueue,
+		Queued,
+		Handler,
+		PageToGame,
+		// game to page
+		BrowserToPage,
+		PageHandlers,
+		GameToPage,
+		Num
+	};
+}
+
+// Per-hook latency of the JavaScript bridge, fed by FRadiantWebView while the
+// RadiantUI.HookTiming console variable is set. Thread-safe.
+class FRadiantHookLatency
+{
+public:
+
+	static FRadiantHookLatency& Get();
+	static bool IsEnabled();
+
+	// InQueuedTime, InDispatchTime and InHandledTime are CefRuntimeTimestamp()s taken by the game.
+	void RecordPageToGame(const FString& InHookName, const CefRuntimeHookTiming& InTiming, double InQueuedTime, double InDispatchTime, double InHandledTime);
+	void RecordGameToPage(const FString& InHookName, const CefRuntimeHookTiming& InTiming);
+
+	// Publishes the totals over all hooks to STATGROUP_RadiantUI, once per frame.
+	void UpdateStats();
+	void Dump();
+	void Reset();
+
+private:
+
+	struct FHookHistograms
+	{
+		FRadiantLatencyHistogram Stages[ERadiantHookStage::Num];
+	};
+
+	FRadiantHookLatency() : StatsFrame(0) {}
+
+	void Record(const FString& InHookName, ERadiantHookStage::Type InStage, double InSeconds);
+
+	FCriticalSection CriticalSection;
+	TMap<FString, TSharedPtr<FHookHistograms> > Hooks;
+	FHookHistograms Totals;
+	uint64 StatsFrame;
+};
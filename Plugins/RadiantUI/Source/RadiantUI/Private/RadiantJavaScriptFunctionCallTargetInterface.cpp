@@ -7,3 +7,8 @@ URadiantJavaScriptFunctionCallTargetInterface::URadiantJavaScriptFunctionCallTar
 : Super(ObjectInitializer)
 {
 }
+
+TSharedPtr<FRadiantWebView> IRadiantJavaScriptFunctionCallTargetInterface::GetJavaScriptWebView()
+{
+	return nullptr;
+}
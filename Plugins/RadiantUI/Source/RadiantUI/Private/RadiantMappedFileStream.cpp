@@ -0,0 +1,103 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "RadiantMappedFileStream.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarMappedFileThreshold(
+		TEXT("RadiantUI.MappedFileThresholdKB"),
+		1024,
+		TEXT("content:// files at least this large are memory-mapped instead of read into memory, 0 disables mapping."));
+}
+
+bool FRadiantMappedFileStream::ShouldMap(int64 InFileSize)
+{
+	const int32 Threshold = CVarMappedFileThreshold.GetValueOnAnyThread();
+	return (Threshold > 0) && (InFileSize >= (int64)Threshold * 1024) && (InFileSize <= MAX_int32);
+}
+
+FRadiantMappedFileStream* FRadiantMappedFileStream::Open(const FString& InPath)
+{
+	IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*InPath);
+	if (!Handle)
+	{
+		return nullptr;
+	}
+
+	const int64 FileSize = Handle->GetFileSize();
+	if ((FileSize <= 0) || (FileSize > MAX_int32))
+	{
+		delete Handle;
+		return nullptr;
+	}
+
+	IMappedFileRegion* Region = Handle->MapRegion(0, FileSize);
+	if (!Region)
+	{
+		delete Handle;
+		return nullptr;
+	}
+
+	return new FRadiantMappedFileStream(Handle, Region);
+}
+
+FRadiantMappedFileStream::FRadiantMappedFileStream(IMappedFileHandle* InHandle, IMappedFileRegion* InRegion)
+: Handle(InHandle)
+, Region(InRegion)
+, Data(InRegion->GetMappedPtr())
+, Size((int32)InRegion->GetMappedSize())
+, Ofs(0)
+{
+}
+
+FRadiantMappedFileStream::~FRadiantMappedFileStream()
+{
+	// regions must go before the handle they were mapped from.
+	delete Region;
+	delete Handle;
+}
+
+void FRadiantMappedFileStream::Release()
+{
+	delete this;
+}
+
+int FRadiantMappedFileStream::Read(void* Ptr, int Count)
+{
+	if (IsEOF())
+	{
+		return 0;
+	}
+
+	Count = FMath::Min(Count, Size - Ofs);
+	FMemory::Memcpy(Ptr, Data + Ofs, Count);
+	Ofs += Count;
+	return Count;
+}
+
+bool FRadiantMappedFileStream::Seek(int Offset, SeekType Whence)
+{
+	switch (Whence)
+	{
+	case ICefStream::Stream_Current:
+		Offset = Ofs + Offset;
+		break;
+	case ICefStream::Stream_End:
+		Offset = Size + Offset;
+		break;
+	case ICefStream::Stream_Set:
+		break;
+	}
+
+	if ((Offset >= 0) && (Offset <= Size))
+	{
+		Ofs = Offset;
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,41 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// ICefStream reading straight out of a memory-mapped file. Nothing is copied up front,
+// pages fault in as CEF reads them and are shared through the OS page cache with every
+// other view mapping the same file.
+class FRadiantMappedFileStream : public ICefStream
+{
+public:
+
+	// Returns null if the file can't be mapped (missing, empty or over 2 GB).
+	static FRadiantMappedFileStream* Open(const FString& InPath);
+
+	// Whether a file this size is served mapped rather than read, see RadiantUI.MappedFileThresholdKB.
+	static bool ShouldMap(int64 InFileSize);
+
+	virtual ~FRadiantMappedFileStream();
+
+	virtual void Release() override;
+	virtual int Read(void* Ptr, int Count) override;
+	virtual bool Seek(int Offset, SeekType Whence) override;
+	virtual int GetPos() override { return Ofs; }
+	virtual bool IsEOF() override { return Ofs >= Size; }
+
+private:
+
+	FRadiantMappedFileStream(IMappedFileHandle* InHandle, IMappedFileRegion* InRegion);
+
+	IMappedFileHandle* Handle;
+	IMappedFileRegion* Region;
+	const uint8* Data;
+	int32 Size;
+	int32 Ofs;
+};
@@ -0,0 +1,355 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "RadiantTextureCache.h"
+#include "AssetRegistryModule.h"
+#include "Async/Async.h"
+#include "CanvasItem.h"
+#include "CanvasTypes.h"
+#include "Containers/Ticker.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarTextureCacheSize(
+		TEXT("RadiantUI.TextureCacheSizeMB"),
+		16,
+		TEXT("Memory budget for game://texture images, 0 disables the cache."));
+
+	// the largest image game://texture will make.
+	const int32 MaxTextureSize = 2048;
+
+	// how long a draw waits for the texture's mips before using the ones already resident.
+	const float MipWaitSeconds = 1.0f;
+
+	void TextureCacheCommand(const TArray<FString>& Args)
+	{
+		FRadiantTextureCache::Get().Dump();
+
+		if ((Args.Num() > 0) && (Args[0] == TEXT("flush")))
+		{
+			FRadiantTextureCache::Get().Flush();
+		}
+	}
+
+	FAutoConsoleCommand TextureCacheConsoleCommand(
+		TEXT("RadiantUI.TextureCache"),
+		TEXT("Logs game://texture cache hit rate and size. Usage: RadiantUI.TextureCache [flush]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&TextureCacheCommand)
+	);
+
+	void Send(const FRadiantTextureCache::FStreamRef& InStream, const FRadiantContentBuffer& InPng)
+	{
+		if (!InPng.IsValid())
+		{
+			InStream->Respond(404, TEXT("text/plain"), TEXT("Not Found"));
+			return;
+		}
+
+#if WITH_EDITOR
+		// reimported textures only show after RadiantUI.TextureCache flush, don't let the
+		// browser hold on to them as well.
+		InStream->SetCacheControl(TEXT("no-cache"));
+#else
+		// cooked textures can't change while the game runs.
+		InStream->SetCacheControl(TEXT("public, max-age=31536000, immutable"));
+#endif
+		InStream->Respond(200, TEXT("image/png"));
+		InStream->Write(InPng->GetData(), InPng->Num());
+		InStream->Finish();
+	}
+}
+
+FRadiantTextureCache& FRadiantTextureCache::Get()
+{
+	static FRadiantTextureCache Instance;
+	return Instance;
+}
+
+FRadiantTextureCache::FRadiantTextureCache()
+: ImageWrapperModule(nullptr)
+, Streamable(nullptr)
+, NextLoadId(0)
+, Target(nullptr)
+, ResidentBytes(0)
+, UseCount(0)
+, Hits(0)
+, Misses(0)
+{
+}
+
+void FRadiantTextureCache::Serve(const FStreamRef& InStream, const FString& InAssetPath, int32 InSize)
+{
+	const int32 Size = FMath::Clamp(InSize, 0, MaxTextureSize);
+	const FString Key = FString::Printf(TEXT("%s?size=%d"), *InAssetPath, Size);
+
+	FRadiantContentBuffer Png;
+	{
+		FScopeLock L(&CriticalSection);
+
+		FEntry* Found = Entries.Find(Key);
+		if (Found)
+		{
+			Found->LastUsed = ++UseCount;
+			Png = Found->Png;
+			++Hits;
+		}
+		else
+		{
+			++Misses;
+
+			TArray<FStreamRef>* Waiting = Pending.Find(Key);
+			if (Waiting)
+			{
+				Waiting->Add(InStream);
+				return;
+			}
+
+			Pending.Add(Key).Add(InStream);
+		}
+	}
+
+	if (Png.IsValid())
+	{
+		Send(InStream, Png);
+		return;
+	}
+
+	AsyncTask(ENamedThreads::GameThread, [Key, InAssetPath, Size]()
+	{
+		FRadiantTextureCache::Get().Load(Key, InAssetPath, Size);
+	});
+}
+
+void FRadiantTextureCache::Load(const FString& InKey, const FString& InAssetPath, int32 InSize)
+{
+	// /Game/UI/T_Icon is short for /Game/UI/T_Icon.T_Icon.
+	FString ObjectPath = InAssetPath;
+	if (!FPackageName::GetShortName(ObjectPath).Contains(TEXT(".")))
+	{
+		ObjectPath += TEXT(".") + FPackageName::GetShortName(ObjectPath);
+	}
+
+	const FSoftObjectPath Path(ObjectPath);
+	if (!Path.IsValid() || !FPackageName::IsValidLongPackageName(Path.GetLongPackageName()))
+	{
+		Complete(InKey, FRadiantContentBuffer());
+		return;
+	}
+
+	// pages choose the path, only textures are worth loading a package for.
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	const FAssetData Asset = AssetRegistry.GetAssetByObjectPath(*Path.ToString());
+	if (!Asset.IsValid() || (Asset.AssetClass != UTexture2D::StaticClass()->GetFName()))
+	{
+		Complete(InKey, FRadiantContentBuffer());
+		return;
+	}
+
+	if (!Streamable)
+	{
+		Streamable = new FStreamableManager();
+	}
+
+	// the slot is added first in case the load finishes before RequestAsyncLoad returns.
+	const uint64 LoadId = ++NextLoadId;
+	Loads.Add(LoadId);
+
+	const FString Key = InKey;
+	TSharedPtr<FStreamableHandle> Handle = Streamable->RequestAsyncLoad(Path, FStreamableDelegate::CreateLambda([Key, Path, InSize, LoadId]()
+	{
+		UTexture2D* Texture = Cast<UTexture2D>(Path.ResolveObject());
+		if (!Texture || !Texture->Resource || (Texture->GetSizeX() < 1) || (Texture->GetSizeY() < 1))
+		{
+			FRadiantTextureCache::Get().ReleaseLoad(LoadId);
+			FRadiantTextureCache::Get().Complete(Key, FRadiantContentBuffer());
+			return;
+		}
+
+		// the mips the draw samples from must be streamed in first. the draw waits for them a
+		// tick at a time, and goes ahead with what is resident if they take too long.
+		Texture->SetForceMipLevelsToBeResident(MipWaitSeconds + 5.0f);
+
+		TWeakObjectPtr<UTexture2D> WeakTexture(Texture);
+		const double Deadline = FPlatformTime::Seconds() + MipWaitSeconds;
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Key, WeakTexture, InSize, Deadline, LoadId](float)
+		{
+			UTexture2D* StreamingTexture = WeakTexture.Get();
+			if (!StreamingTexture || !StreamingTexture->Resource)
+			{
+				FRadiantTextureCache::Get().ReleaseLoad(LoadId);
+				FRadiantTextureCache::Get().Complete(Key, FRadiantContentBuffer());
+				return false;
+			}
+
+			if (!StreamingTexture->IsFullyStreamedIn() && (FPlatformTime::Seconds() < Deadline))
+			{
+				return true;
+			}
+
+			// the draw is enqueued with the texture's resource, so the handle can go after it.
+			FRadiantTextureCache::Get().Draw(Key, StreamingTexture, InSize);
+			FRadiantTextureCache::Get().ReleaseLoad(LoadId);
+			return false;
+		}));
+	}));
+
+	if (TSharedPtr<FStreamableHandle>* Slot = Loads.Find(LoadId))
+	{
+		*Slot = Handle;
+	}
+
+	// nothing to wait for, the delegate won't run.
+	if (!Handle.IsValid())
+	{
+		ReleaseLoad(LoadId);
+		Complete(InKey, FRadiantContentBuffer());
+	}
+}
+
+void FRadiantTextureCache::ReleaseLoad(uint64 InLoadId)
+{
+	Loads.Remove(InLoadId);
+}
+
+void FRadiantTextureCache::Draw(const FString& InKey, UTexture2D* InTexture, int32 InSize)
+{
+	// InSize is the width, a tall texture is scaled down further so neither side exceeds MaxTextureSize.
+	const int32 SizeX = InTexture->GetSizeX();
+	const int32 SizeY = InTexture->GetSizeY();
+	float Scale = (InSize > 0) ? ((float)InSize / SizeX) : 1.0f;
+	Scale = FMath::Min(Scale, (float)MaxTextureSize / FMath::Max(SizeX, SizeY));
+
+	const int32 Width = FMath::Clamp(FMath::RoundToInt(SizeX * Scale), 1, MaxTextureSize);
+	const int32 Height = FMath::Clamp(FMath::RoundToInt(SizeY * Scale), 1, MaxTextureSize);
+
+	// one target serves every image. render commands run in order, so each readback sees
+	// its own draw before the next draw or resize touches the target.
+	if (!Target)
+	{
+		Target = NewObject<UTextureRenderTarget2D>();
+		Target->AddToRoot();
+		Target->ClearColor = FLinearColor::Transparent;
+	}
+
+	if (!Target->Resource || (Target->SizeX != Width) || (Target->SizeY != Height))
+	{
+		Target->InitCustomFormat(Width, Height, PF_B8G8R8A8, false);
+	}
+
+	FTextureRenderTargetResource* TargetResource = Target->GameThread_GetRenderTargetResource();
+	{
+		FCanvas Canvas(TargetResource, nullptr, nullptr, GMaxRHIFeatureLevel);
+		Canvas.Clear(FLinearColor::Transparent);
+
+		// opaque so the texture's alpha is written as is rather than blended.
+		FCanvasTileItem Tile(FVector2D::ZeroVector, InTexture->Resource, FVector2D(Width, Height), FLinearColor::White);
+		Tile.BlendMode = SE_BLEND_Opaque;
+		Canvas.DrawItem(Tile);
+		Canvas.Flush_GameThread();
+	}
+
+	if (!ImageWrapperModule)
+	{
+		// modules are loaded on the game thread, the wrappers themselves can be used anywhere.
+		ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	}
+
+	IImageWrapperModule* Wrappers = ImageWrapperModule;
+	const FString Key = InKey;
+	ENQUEUE_RENDER_COMMAND(RadiantTextureReadback)(
+		[TargetResource, Width, Height, Key, Wrappers](FRHICommandListImmediate& RHICmdList)
+	{
+		TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe> Pixels = MakeShareable(new TArray<FColor>());
+		RHICmdList.ReadSurfaceData(TargetResource->GetRenderTargetTexture(), FIntRect(0, 0, Width, Height), *Pixels, FReadSurfaceDataFlags(RCM_UNorm));
+
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Key, Pixels, Width, Height, Wrappers]()
+		{
+			FRadiantContentBuffer Png;
+
+			TSharedPtr<IImageWrapper> Wrapper = Wrappers->CreateImageWrapper(EImageFormat::PNG);
+			if ((Pixels->Num() == Width * Height) && Wrapper.IsValid() && Wrapper->SetRaw(Pixels->GetData(), Pixels->Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8))
+			{
+				Png = MakeShareable(new TArray<uint8>(Wrapper->GetCompressed()));
+			}
+
+			FRadiantTextureCache::Get().Complete(Key, Png);
+		});
+	});
+}
+
+void FRadiantTextureCache::Complete(const FString& InKey, const FRadiantContentBuffer& InPng)
+{
+	const int64 Budget = (int64)FMath::Max(CVarTextureCacheSize.GetValueOnAnyThread(), 0) * 1024 * 1024;
+
+	TArray<FStreamRef> Waiting;
+	{
+		FScopeLock L(&CriticalSection);
+
+		Pending.RemoveAndCopyValue(InKey, Waiting);
+
+		// missing textures aren't remembered, they may be loadable later.
+		if (InPng.IsValid() && (InPng->Num() <= (Budget / 4)))
+		{
+			FEntry* Existing = Entries.Find(InKey);
+			if (Existing)
+			{
+				ResidentBytes -= Existing->Png->Num();
+			}
+
+			FEntry& Entry = Entries.Add(InKey);
+			Entry.Png = InPng;
+			Entry.LastUsed = ++UseCount;
+			ResidentBytes += InPng->Num();
+
+			Trim(Budget);
+		}
+	}
+
+	for (const FStreamRef& Stream : Waiting)
+	{
+		Send(Stream, InPng);
+	}
+}
+
+void FRadiantTextureCache::Trim(int64 InBudget)
+{
+	while ((ResidentBytes > InBudget) && (Entries.Num() > 0))
+	{
+		// few enough images that a scan for the oldest is cheaper than keeping a list.
+		FString OldestKey;
+		uint64 OldestUse = MAX_uint64;
+		for (const TPair<FString, FEntry>& Entry : Entries)
+		{
+			if (Entry.Value.LastUsed < OldestUse)
+			{
+				OldestKey = Entry.Key;
+				OldestUse = Entry.Value.LastUsed;
+			}
+		}
+
+		ResidentBytes -= Entries.FindChecked(OldestKey).Png->Num();
+		Entries.Remove(OldestKey);
+	}
+}
+
+void FRadiantTextureCache::Flush()
+{
+	FScopeLock L(&CriticalSection);
+	Trim(-1);
+}
+
+void FRadiantTextureCache::Dump()
+{
+	FScopeLock L(&CriticalSection);
+
+	const uint64 Lookups = Hits + Misses;
+	UE_LOG(RadiantUILog, Display, TEXT("RadiantUI texture cache: %d images, %.2f MB resident (budget %d MB), %d being made"),
+		Entries.Num(), ResidentBytes / (1024.0 * 1024.0), CVarTextureCacheSize.GetValueOnAnyThread(), Pending.Num());
+	UE_LOG(RadiantUILog, Display, TEXT("  %llu hits, %llu misses, %.1f%% hit rate"),
+		Hits, Misses, (Lookups > 0) ? (100.0 * Hits / Lookups) : 0.0);
+}
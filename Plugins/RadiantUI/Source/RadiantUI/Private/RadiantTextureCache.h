@@ -0,0 +1,71 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "RadiantContentCache.h"
+#include "RadiantDataStream.h"
+
+class IImageWrapperModule;
+class UTexture2D;
+class UTextureRenderTarget2D;
+struct FStreamableHandle;
+struct FStreamableManager;
+
+// Serves game://texture/<asset path>?size=<pixels> as PNG, so pages can show the game's own
+// icons without exported copies. The texture is loaded asynchronously and drawn into a render
+// target of the requested width once its mips are resident, which takes care of compressed
+// formats and mip selection. The pixels are read back by a render command and encoded on a
+// worker, so the game thread never waits on either. Encoded images are shared by every web
+// view and kept in an LRU bounded by RadiantUI.TextureCacheSizeMB, hits are answered on the
+// CEF IO thread.
+class FRadiantTextureCache
+{
+public:
+
+	typedef TSharedRef<FRadiantDataStream, ESPMode::ThreadSafe> FStreamRef;
+
+	static FRadiantTextureCache& Get();
+
+	// Answers InStream, which must still be holding its headers. InAssetPath is a package
+	// or object path, InSize the image width in pixels (0 for the texture's own width).
+	void Serve(const FStreamRef& InStream, const FString& InAssetPath, int32 InSize);
+
+	void Flush();
+	void Dump();
+
+private:
+
+	struct FEntry
+	{
+		FRadiantContentBuffer Png;
+		uint64 LastUsed;
+	};
+
+	FRadiantTextureCache();
+
+	// game thread. Load starts the async load, Draw runs once the mips are in.
+	void Load(const FString& InKey, const FString& InAssetPath, int32 InSize);
+	void Draw(const FString& InKey, UTexture2D* InTexture, int32 InSize);
+	// game thread, lets go of the texture once its image has been drawn or given up on.
+	void ReleaseLoad(uint64 InLoadId);
+	// any thread, InPng is null if there is no such texture.
+	void Complete(const FString& InKey, const FRadiantContentBuffer& InPng);
+	void Trim(int64 InBudget);
+
+	FCriticalSection CriticalSection;
+	TMap<FString, FEntry> Entries;
+	// requests waiting on an image being made, so each is only made once.
+	TMap<FString, TArray<FStreamRef>> Pending;
+	IImageWrapperModule* ImageWrapperModule;
+	// game thread only, created on first use and kept for the life of the game.
+	FStreamableManager* Streamable;
+	// handles keep their texture loaded until it has been drawn.
+	TMap<uint64, TSharedPtr<FStreamableHandle>> Loads;
+	uint64 NextLoadId;
+	UTextureRenderTarget2D* Target;
+	int64 ResidentBytes;
+	uint64 UseCount;
+	uint64 Hits;
+	uint64 Misses;
+};
@@ -3,6 +3,8 @@
 
 #include "RadiantUIPrivatePCH.h"
 #include "ModuleManager.h"
+#include "Misc/HotReloadInterface.h"
+#include "JSCall.h"
 
 DEFINE_LOG_CATEGORY(RadiantUILog);
 
@@ -32,11 +34,63 @@ class FRadiantUIModule : public IModuleInterface, public ICefRuntimeCallbacks
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override
 	{
-		CefRuntimeAPI = CefStartup(this);
+		// [RadiantUI] CachePath is the default profile's disk cache, relative to Saved. Without
+		// it the default profile caches in memory only.
+		FString CachePath;
+		int32 DiskCacheSizeMB = 0;
+		bool bV8CodeCache = true;
+		bool bProcessPerSite = false;
+		GConfig->GetString(TEXT("RadiantUI"), TEXT("CachePath"), CachePath, GGameIni);
+		GConfig->GetInt(TEXT("RadiantUI"), TEXT("DiskCacheSizeMB"), DiskCacheSizeMB, GGameIni);
+		GConfig->GetBool(TEXT("RadiantUI"), TEXT("V8CodeCache"), bV8CodeCache, GGameIni);
+		GConfig->GetBool(TEXT("RadiantUI"), TEXT("ProcessPerSite"), bProcessPerSite, GGameIni);
+
+		FTCHARToUTF8 ConvertCachePath(*ResolveCachePath(CachePath));
+
+		CefRuntimeSettings Settings;
+		Settings.CachePath = ConvertCachePath.Get();
+		Settings.DiskCacheSizeMB = DiskCacheSizeMB;
+		Settings.V8CodeCache = bV8CodeCache;
+		Settings.ProcessPerSite = bProcessPerSite;
+
+		CefRuntimeAPI = CefStartup(this, Settings);
+
+		if (CefRuntimeAPI)
+		{
+			RegisterMimeTypes();
+			AddRequestContexts();
+
+			if (!GIsEditor)
+			{
+				MountContentArchives();
+			}
+		}
+
+		IHotReloadInterface* HotReload = IHotReloadInterface::GetPtr();
+		if (HotReload)
+		{
+			HotReloadHandle = HotReload->OnHotReload().AddStatic(&FRadiantUIModule::OnHotReload);
+		}
+
+#if WITH_EDITOR
+		ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddStatic(&FRadiantUIModule::OnObjectsReplaced);
+#endif
 	}
 
 	virtual void ShutdownModule() override
 	{
+		IHotReloadInterface* HotReload = IHotReloadInterface::GetPtr();
+		if (HotReload)
+		{
+			HotReload->OnHotReload().Remove(HotReloadHandle);
+		}
+
+#if WITH_EDITOR
+		FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+#endif
+
+		FJavaScriptHelper::FlushCaches();
+
 		if (CefRuntimeAPI)
 		{
 			CefRuntimeAPI->Release();
@@ -44,6 +98,111 @@ class FRadiantUIModule : public IModuleInterface, public ICefRuntimeCallbacks
 		}
 	}
 
+	static FString ResolveCachePath(const FString& InPath)
+	{
+		return InPath.IsEmpty() ? InPath : FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir(), InPath);
+	}
+
+	// Adds the [RadiantUI] RequestContexts profiles from the game ini, each
+	// (Name="<name>",CachePath="<directory relative to Saved>"). Without a CachePath the
+	// profile's cache is in memory, but still shared by its views and apart from other profiles.
+	void AddRequestContexts()
+	{
+		TArray<FString> Profiles;
+		GConfig->GetArray(TEXT("RadiantUI"), TEXT("RequestContexts"), Profiles, GGameIni);
+
+		for (const FString& Entry : Profiles)
+		{
+			FString Name, CachePath;
+			if (!FParse::Value(*Entry, TEXT("Name="), Name) || Name.IsEmpty())
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("Ignoring RequestContexts entry '%s', it has no Name."), *Entry);
+				continue;
+			}
+
+			FParse::Value(*Entry, TEXT("CachePath="), CachePath);
+			CachePath = ResolveCachePath(CachePath);
+
+			if (CefRuntimeAPI->AddRequestContext(TCHAR_TO_UTF8(*Name), TCHAR_TO_UTF8(*CachePath)))
+			{
+				UE_LOG(RadiantUILog, Log, TEXT("Request context %s caching %s"), *Name, CachePath.IsEmpty() ? TEXT("in memory") : *CachePath);
+			}
+			else
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("Couldn't add request context %s, is the name used twice?"), *Name);
+			}
+		}
+	}
+
+	// Adds the [RadiantUI] MimeTypes entries from the game ini, each <extension>=<type>,
+	// e.g. +MimeTypes=glb=model/gltf-binary.
+	void RegisterMimeTypes()
+	{
+		TArray<FString> MimeTypes;
+		GConfig->GetArray(TEXT("RadiantUI"), TEXT("MimeTypes"), MimeTypes, GGameIni);
+
+		for (const FString& Entry : MimeTypes)
+		{
+			FString Extension, MimeType;
+			if (Entry.Split(TEXT("="), &Extension, &MimeType))
+			{
+				CefRuntimeAPI->RegisterMimeType(TCHAR_TO_UTF8(*Extension.TrimStartAndEnd()), TCHAR_TO_UTF8(*MimeType.TrimStartAndEnd()));
+			}
+			else
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("Ignoring MimeTypes entry '%s', expected <extension>=<type>."), *Entry);
+			}
+		}
+	}
+
+	// Mounts the archives listed under [RadiantUI] ContentArchives in the game ini. Each
+	// entry <Name> mounts Content/<Name>.zip over content://<Name>/, so the page URLs don't
+	// change. The editor always serves the loose files.
+	void MountContentArchives()
+	{
+		TArray<FString> Archives;
+		GConfig->GetArray(TEXT("RadiantUI"), TEXT("ContentArchives"), Archives, GGameIni);
+
+		for (const FString& Name : Archives)
+		{
+			const FString ArchivePath = FPaths::ProjectContentDir() / Name + TEXT(".zip");
+
+			TArray<uint8> Data;
+			if (!FFileHelper::LoadFileToArray(Data, *ArchivePath))
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("Content archive %s not found, serving loose files."), *ArchivePath);
+				continue;
+			}
+
+			const int NumFiles = CefRuntimeAPI->MountContentArchive(Data.GetData(), Data.Num(), TCHAR_TO_UTF8(*Name));
+			if (NumFiles > 0)
+			{
+				UE_LOG(RadiantUILog, Log, TEXT("Mounted %d files from %s at content://%s/"), NumFiles, *ArchivePath, *Name);
+			}
+			else
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("Content archive %s could not be read."), *ArchivePath);
+			}
+		}
+	}
+
+	static void OnHotReload(bool bWasTriggeredAutomatically)
+	{
+		FJavaScriptHelper::FlushCaches();
+	}
+
+#if WITH_EDITOR
+	// recompiling a blueprint reinstances its class and the structs it owns.
+	static void OnObjectsReplaced(const TMap<UObject*, UObject*>& ReplacementMap)
+	{
+		FJavaScriptHelper::FlushCaches();
+	}
+
+	FDelegateHandle ObjectsReplacedHandle;
+#endif
+
+	FDelegateHandle HotReloadHandle;
+
 	/*virtual bool IsTickable() const override
 	{
 		return CefApplication.get() != NULL;
@@ -13,6 +13,7 @@
 #include "RadiantJavaScriptFunctionCall.h"
 #include "RadiantJavaScriptFunctionCallLibrary.h"
 #include "RadiantWebViewInputMaskedActionList.h"
+#include "RadiantDataStream.h"
 #include "RadiantWebView.h"
 #include "RadiantWebViewHUDElement.h"
 #include "RadiantWebViewHUD.h"
@@ -20,6 +21,7 @@
 #include "RadiantWebViewInputComponent.h"
 #include "RadiantWebViewInteractionComponent.h"
 #include "RadiantWebViewRenderComponent.h"
+#include "RadiantWebViewBindingComponent.h"
 #include "RadiantWebViewActor.h"
 #include "RadiantStaticMeshWebViewActor.h"
 #include "RadiantCanvasRenderTarget.h"
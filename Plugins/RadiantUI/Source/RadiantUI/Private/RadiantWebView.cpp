@@ -3,7 +3,12 @@
 
 #include "RadiantUIPrivatePCH.h"
 #include "RadiantWebView.h"
+#include "RadiantContentCache.h"
+#include "RadiantHookLatency.h"
+#include "RadiantMappedFileStream.h"
+#include "RadiantTextureCache.h"
 #include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
+#include "Async/Async.h"
 #include "AllowWindowsPlatformTypes.h"
 #include <windows.h>
 #include "HideWindowsPlatformTypes.h"
@@ -16,82 +21,6 @@ struct FRect
 	uint16 H;
 };
 
-namespace
-{
-	class NakedFileStream : public ICefStream
-	{
-	public:
-		int32 Ofs;
-		TArray<uint8> Data;
-
-		NakedFileStream() : Ofs(0)
-		{
-		}
-
-		virtual void Release()
-		{
-			delete this;
-		}
-
-		virtual int Read(void* Ptr, int Count)
-		{
-			if (IsEOF())
-			{
-				return 0;
-			}
-
-			Count = ((Ofs + Count) <= Data.Num()) ? Count : (Data.Num() - Ofs);
-			FMemory::Memcpy(Ptr, &Data[Ofs], Count);
-			Ofs += Count;
-			return Count;
-		}
-
-		virtual bool Seek(int Offset, SeekType Whence)
-		{
-			switch (Whence)
-			{
-			case ICefStream::Stream_Current:
-				Offset = Ofs + Offset;
-				break;
-			case ICefStream::Stream_End:
-				Offset = Data.Num() + Offset;
-				break;
-			case ICefStream::Stream_Set:
-				break;
-			}
-
-			if ((Offset >= 0) && (Offset < Data.Num()))
-			{
-				Ofs = Offset;
-				return true;
-			}
-
-			return false;
-		}
-
-		virtual int GetPos()
-		{
-			return Ofs;
-		}
-
-		virtual bool IsEOF()
-		{
-			return Ofs >= Data.Num();
-		}
-	};
-
-	ICefStream* LoadFileToStream(const FString& FilePath)
-	{
-		NakedFileStream* Stream = new NakedFileStream();
-		if (FFileHelper::LoadFileToArray(Stream->Data, *FilePath))
-		{
-			return Stream;
-		}
-		delete Stream;
-		return nullptr;
-	}
-}
-
 class FRadiantWebViewCallbacks : public ICefWebViewCallbacks
 {
 public:
@@ -113,6 +42,12 @@ public:
 		Component->Repaint(InNumRegions, InRegions, InBuffer, InWidth, InHeight);
 	}
 
+	virtual void FenceReached(int InSequence) override
+	{
+		check(Component);
+		Component->FenceReached(InSequence);
+	}
+
 	// Called when the cursor changes
 	virtual void OnCursorChange(void* InPlatformCursorHandle) override
 	{
@@ -128,10 +63,24 @@ public:
 	}
 
 	// Called by JavaScript to execute a hook function in the game
-	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments) override
+	virtual void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments, const CefRuntimeHookTiming* InTiming) override
 	{
 		check(Component);
-		Component->ExecuteJSHook(InHookName, InArguments);
+		Component->ExecuteJSHook(InHookName, InArguments, InTiming);
+	}
+
+	// Called when a timed hook sent to JavaScript has run
+	virtual void JSHookDelivered(const char* InHookName, const CefRuntimeHookTiming& InTiming) override
+	{
+		check(Component);
+		Component->JSHookDelivered(InHookName, InTiming);
+	}
+
+	// Called by RadiantUI.Call() to execute a game function and return its result
+	virtual void ExecuteJSCall(int InCallId, const char* InName, ICefRuntimeVariantList* InArguments) override
+	{
+		check(Component);
+		Component->ExecuteJSCall(InCallId, InName, InArguments);
 	}
 
 	virtual ICefStream* GetFileStream(const char* FilePath) override
@@ -140,6 +89,24 @@ public:
 		return Component->GetFileStream(FilePath);
 	}
 
+	virtual ICefDataStream* CreateDataStream(const char* InChannel, const char* InQuery) override
+	{
+		check(Component);
+		return Component->CreateDataStream(InChannel, InQuery);
+	}
+
+	virtual ICefDataStream* CreateApiStream(const char* InMethod, const char* InPath, const char* InQuery, const void* InBody, int InBodySize) override
+	{
+		check(Component);
+		return Component->CreateApiStream(InMethod, InPath, InQuery, InBody, InBodySize);
+	}
+
+	virtual ICefDataStream* CreateTextureStream(const char* InAssetPath, const char* InQuery) override
+	{
+		check(Component);
+		return Component->CreateTextureStream(InAssetPath, InQuery);
+	}
+
 	// When the associated webview is being released.
 	// If there are no more references to the ICefWebViewCallbacks 
 	// object it should be destroyed by the owner.
@@ -198,11 +165,30 @@ FRadiantWebViewCursorSet::FRadiantWebViewCursorSet()
 
 FRadiantWebView::FRadiantWebView(const FRadiantWebViewDefaultSettings& Settings)
 : URL(Settings.URL)
+, RequestContext(Settings.RequestContext)
 , Size(Settings.Size)
 , InitialCanvasColor(Settings.InitialCanvasColor)
 , Cursors(Settings.Cursors)
 , bCursorEnabled(Settings.bProjectedCursor)
 , RefreshRate(Settings.RefreshRate)
+, bGameDrivenAnimation(Settings.bGameDrivenAnimation)
+, AnimationFrameTime(0.0f)
+, LastRealTime(0.0f)
+, AnimationFrameNumber(0)
+, PerformanceHints(Settings.PerformanceHints)
+, PerformanceHint(ERadiantPerformanceHint::Full)
+, PendingPerformanceHint(ERadiantPerformanceHint::Full)
+, PendingPerformanceHintTime(0.0f)
+, FrameTimeAverage(0.0f)
+, PaintTimeAverage(0.0f)
+, PaintSecondsSinceTick(0.0)
+, NextFence(0)
+, PaintedFence(0)
+, PresentedFence(0)
+, LastFenceLatency(0.0f)
+, bWaitForFences(false)
+, MaxFenceWait(0.1f)
+, bHookTiming(false)
 {
 	bCursorVisible = false;
 	bFocusingEditableField = true;
@@ -212,6 +198,8 @@ FRadiantWebView::FRadiantWebView(const FRadiantWebViewDefaultSettings& Settings)
 
 	NumPendingRenderCommands = 0;
 	WebView = nullptr;
+	CompiledGeneration = 0;
+	BrowserGeneration = 0;
 	WebViewTexture = nullptr;
 	WebViewCanvas = nullptr;
 	SurfacePtr = nullptr;
@@ -464,11 +452,13 @@ void FRadiantWebView::CreateBrowser()
 	if (API)
 	{
 		FTCHARToUTF8 Convert(*URL);
+		FTCHARToUTF8 ConvertContext(*RequestContext);
 		API->CreateWebView(
 			Convert.Get(), 
 			Size.X, 
 			Size.Y, 
 			bTransparentRendering, 
+			ConvertContext.Get(),
 			CallbacksInterface
 			);
 	}
@@ -528,7 +518,18 @@ void FRadiantWebView::FlushRenderUpdates()
 
 void FRadiantWebView::Tick(float InRealTime, float InWorldTime, float InWorldDeltaTime, ERHIFeatureLevel::Type FeatureLevel)
 {
+	if (WebView && (bHookTiming != FRadiantHookLatency::IsEnabled()))
+	{
+		bHookTiming = !bHookTiming;
+		WebView->SetHookTimingEnabled(bHookTiming);
+	}
+
 	ProcessPendingCallbacks();
+	const float RealDeltaTime = FMath::Max(InRealTime - LastRealTime, 0.0f);
+	LastRealTime = InRealTime;
+
+	TickAnimationFrame(InRealTime, RealDeltaTime, InWorldTime, InWorldDeltaTime);
+	TickPerformanceHint(RealDeltaTime);
 
 	if (!bDedicatedServer)
 	{
@@ -637,6 +638,121 @@ void FRadiantWebView::CallJavaScriptFunction(const char* InHookName, ICefRuntime
 	}
 }
 
+namespace
+{
+	// Hands a script result to the game thread, deleted once CEF has answered.
+	class FRadiantScriptCallback : public ICefScriptCallback
+	{
+	public:
+
+		explicit FRadiantScriptCallback(const FRadiantWebView::FScriptCompleted& InCompleted) : Completed(InCompleted) {}
+
+		virtual void ScriptCompleted(ICefRuntimeVariant* InResult, const char* InError) override
+		{
+			if (InResult)
+			{
+				InResult->AddRef();
+			}
+
+			FRadiantWebView::FScriptCompleted Callback = Completed;
+			FString Error = InError ? UTF8_TO_TCHAR(InError) : TEXT("");
+
+			AsyncTask(ENamedThreads::GameThread, [Callback, InResult, Error]()
+			{
+				Callback(InResult, Error);
+				if (InResult)
+				{
+					InResult->Release();
+				}
+			});
+
+			delete this;
+		}
+
+	private:
+
+		FRadiantWebView::FScriptCompleted Completed;
+	};
+
+	ICefScriptCallback* MakeScriptCallback(const FRadiantWebView::FScriptCompleted& InCompleted)
+	{
+		return InCompleted ? new FRadiantScriptCallback(InCompleted) : nullptr;
+	}
+}
+
+void FRadiantWebView::ExecuteScript(const FString& InSource, FScriptCompleted InCompleted)
+{
+	AcquireBrowser();
+	if (!WebView)
+	{
+		if (InCompleted)
+		{
+			InCompleted(nullptr, TEXT("the browser has not been created"));
+		}
+		return;
+	}
+
+	FTCHARToUTF8 Convert(*InSource);
+	WebView->ExecuteScript(Convert.Get(), MakeScriptCallback(InCompleted));
+}
+
+int32 FRadiantWebView::CompileScript(const FString& InSource)
+{
+	FCompiledScript& Script = CompiledScripts[CompiledScripts.AddDefaulted()];
+	Script.Source = InSource;
+	Script.BrowserHandle = 0;
+	return CompiledScripts.Num();
+}
+
+void FRadiantWebView::ExecuteCompiledScript(int32 InScript, FScriptCompleted InCompleted)
+{
+	AcquireBrowser();
+	if (!WebView || !CompiledScripts.IsValidIndex(InScript - 1))
+	{
+		if (InCompleted)
+		{
+			InCompleted(nullptr, WebView ? TEXT("unknown script handle") : TEXT("the browser has not been created"));
+		}
+		return;
+	}
+
+	// handles from an earlier browser mean nothing to this one.
+	if (CompiledGeneration != BrowserGeneration)
+	{
+		CompiledGeneration = BrowserGeneration;
+		for (FCompiledScript& Each : CompiledScripts)
+		{
+			Each.BrowserHandle = 0;
+		}
+	}
+
+	FCompiledScript& Script = CompiledScripts[InScript - 1];
+	if (!Script.BrowserHandle)
+	{
+		FTCHARToUTF8 Convert(*Script.Source);
+		Script.BrowserHandle = WebView->CompileScript(Convert.Get());
+	}
+
+	WebView->ExecuteCompiledScript(Script.BrowserHandle, MakeScriptCallback(InCompleted));
+}
+
+ICefSharedState* FRadiantWebView::GetSharedState()
+{
+	AcquireBrowser();
+	if (WebView)
+	{
+		return WebView->GetSharedState();
+	}
+
+	return nullptr;
+}
+
+int32 FRadiantWebView::GetStateBindCount(const FString& InChannel) const
+{
+	const int32* Count = StateBindCounts.Find(InChannel);
+	return Count ? *Count : 0;
+}
+
 void FRadiantWebView::ProcessPendingCallbacks()
 {
 	const int MaxCallbacksPerFrame = 8;
@@ -650,26 +766,242 @@ void FRadiantWebView::ProcessPendingCallbacks()
 			Stack[NumCallbacks++] = *It;
 		}
 
-		PendingCallbacks.Empty(PendingCallbacks.Max());
+		// anything over the limit waits for the next frame, dropping it would leave promises unresolved.
+		PendingCallbacks.RemoveAt(0, NumCallbacks, false);
 	}
 
 	for (int i = 0; i < NumCallbacks; ++i)
 	{
 		const FQueuedCallback& Callback = Stack[i];
-		OnExecuteJSHook.Broadcast(Callback.HookName, Callback.Arguments);
+
+		if (Callback.CallId != INDEX_NONE)
+		{
+			DispatchJSCall(Callback);
+			continue;
+		}
+
+		const double DispatchTime = (Callback.QueuedTime > 0.0) ? CefRuntimeTimestamp() : 0.0;
+
+		FNativeHook* NativeHook = NativeHooks.Find(Callback.HookName);
+		if (NativeHook)
+		{
+			(*NativeHook)(Callback.Arguments);
+		}
+		else if (Callback.HookName == TEXT("RadiantUI.BindState"))
+		{
+			// sent by RadiantUI.BindState() itself, read by URadiantWebViewBindingComponent.
+			ICefRuntimeVariant* Channel = (Callback.Arguments && (Callback.Arguments->GetSize() > 0)) ? Callback.Arguments->GetValue(0) : nullptr;
+			if (Channel && Channel->IsString())
+			{
+				++StateBindCounts.FindOrAdd(UTF8_TO_TCHAR(static_cast<ICefRuntimeVariantString*>(Channel)->GetValue()));
+			}
+		}
+		else
+		{
+			OnExecuteJSHook.Broadcast(Callback.HookName, Callback.Arguments);
+		}
+
+		if (DispatchTime > 0.0)
+		{
+			FRadiantHookLatency::Get().RecordPageToGame(Callback.HookName, Callback.Timing, Callback.QueuedTime, DispatchTime, CefRuntimeTimestamp());
+		}
+	}
+
+	if (bHookTiming)
+	{
+		FRadiantHookLatency::Get().UpdateStats();
 	}
+
+	FRadiantContentCache::Get().UpdateStats();
 }
 
-void FRadiantWebView::ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments)
+void FRadiantWebView::UnbindHook(const FString& InHookName)
 {
+	NativeHooks.Remove(InHookName);
+}
+
+void FRadiantWebView::ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments, const CefRuntimeHookTiming* InTiming)
+{
+	FQueuedCallback Callback(FString(InHookName), InArguments);
+	if (InTiming)
+	{
+		Callback.Timing = *InTiming;
+		Callback.QueuedTime = CefRuntimeTimestamp();
+	}
+
 	FScopeLock L(&CriticalSection);
-	PendingCallbacks.Add(FQueuedCallback(FString(InHookName), InArguments));
+	PendingCallbacks.Add(Callback);
+}
+
+void FRadiantWebView::JSHookDelivered(const char* InHookName, const CefRuntimeHookTiming& InTiming)
+{
+	FRadiantHookLatency::Get().RecordGameToPage(FString(InHookName), InTiming);
+}
+
+void FRadiantWebView::ExecuteJSCall(int InCallId, const char* InName, ICefRuntimeVariantList* InArguments)
+{
+	FScopeLock L(&CriticalSection);
+	PendingCallbacks.Add(FQueuedCallback(FString(InName), InArguments, InCallId));
+}
+
+void FRadiantWebView::DispatchJSCall(const FQueuedCallback& InCall)
+{
+	if (!WebView)
+	{
+		return;
+	}
+
+	FString Error;
+	ICefRuntimeVariant* Result = nullptr;
+
+	if (InCall.HookName == TEXT("RadiantUI.GetPerformanceHint"))
+	{
+		// lets a page that loads after the last change pick up the current level.
+		FTCHARToUTF8 Convert(GetPerformanceHintName(PerformanceHint));
+		Result = GetVariantFactory()->CreateString(Convert.Get());
+	}
+	else if (OnExecuteJSCall.IsBound())
+	{
+		Result = OnExecuteJSCall.Execute(InCall.HookName, InCall.Arguments, Error);
+	}
+	else
+	{
+		Error = TEXT("no call handler is bound");
+	}
+
+	if (Result)
+	{
+		WebView->CompleteJSCall(InCall.CallId, Result, nullptr);
+		Result->Release();
+	}
+	else
+	{
+		if (Error.IsEmpty())
+		{
+			Error = TEXT("call failed");
+		}
+
+		UE_LOG(RadiantUILog, Warning, TEXT("RadiantUI.Call('%s') failed: %s"), *InCall.HookName, *Error);
+
+		FTCHARToUTF8 Convert(*Error);
+		WebView->CompleteJSCall(InCall.CallId, nullptr, Convert.Get());
+	}
 }
 
 void FRadiantWebView::WebViewCreated(ICefWebView* InWebView)
 {
 	WebView = InWebView;
 	WebView->SendFocusEvent(false);
+	++BrowserGeneration;
+	{
+		// fences sent to the previous browser will never be reached.
+		FScopeLock L(&CriticalSection);
+		PendingFences.Reset();
+	}
+	// a new browser starts untimed, Tick() re-applies RadiantUI.HookTiming.
+	bHookTiming = false;
+}
+
+void FRadiantWebView::TickAnimationFrame(float InRealTime, float InRealDeltaTime, float InWorldTime, float InWorldDeltaTime)
+{
+	if (!bGameDrivenAnimation || !bRunning || !WebView)
+	{
+		return;
+	}
+
+	// paced on real time, menus keep animating while the world is paused.
+	AnimationFrameTime += InRealDeltaTime;
+	if ((RefreshRate > 0.0f) && (AnimationFrameTime < (1.0f / RefreshRate)))
+	{
+		return;
+	}
+
+	// (timestamp ms, delta ms, world time, world delta, frame number), see RadiantUI.requestAnimationFrame.
+	CallJavaScript("RadiantUI.Frame", (double)InRealTime * 1000.0, (double)AnimationFrameTime * 1000.0, (double)InWorldTime, (double)InWorldDeltaTime, ++AnimationFrameNumber);
+
+	AnimationFrameTime = 0.0f;
+}
+
+const TCHAR* FRadiantWebView::GetPerformanceHintName(ERadiantPerformanceHint::Type InHint)
+{
+	switch (InHint)
+	{
+	case ERadiantPerformanceHint::Reduced:
+		return TEXT("reduced");
+	case ERadiantPerformanceHint::Minimal:
+		return TEXT("minimal");
+	default:
+		return TEXT("full");
+	}
+}
+
+void FRadiantWebView::TickPerformanceHint(float InRealDeltaTime)
+{
+	double PaintSeconds;
+	{
+		FScopeLock L(&CriticalSection);
+		PaintSeconds = PaintSecondsSinceTick;
+		PaintSecondsSinceTick = 0.0;
+	}
+
+	if (!PerformanceHints.bEnabled || !bRunning || (InRealDeltaTime <= 0.0f))
+	{
+		return;
+	}
+
+	// averaged over roughly half a second so single hitches don't count.
+	const float Alpha = FMath::Clamp(InRealDeltaTime * 2.0f, 0.0f, 1.0f);
+	FrameTimeAverage = FMath::Lerp(FrameTimeAverage, InRealDeltaTime * 1000.0f, Alpha);
+	PaintTimeAverage = FMath::Lerp(PaintTimeAverage, (float)(PaintSeconds * 1000.0), Alpha);
+
+	auto GetLevel = [this](float InScale)
+	{
+		if ((FrameTimeAverage > PerformanceHints.MinimalFrameTime * InScale) || (PaintTimeAverage > PerformanceHints.MinimalPaintTime * InScale))
+		{
+			return ERadiantPerformanceHint::Minimal;
+		}
+		if ((FrameTimeAverage > PerformanceHints.ReducedFrameTime * InScale) || (PaintTimeAverage > PerformanceHints.ReducedPaintTime * InScale))
+		{
+			return ERadiantPerformanceHint::Reduced;
+		}
+		return ERadiantPerformanceHint::Full;
+	};
+
+	// recovering needs a margin below the thresholds, otherwise a view sitting on one flips every few seconds.
+	const ERadiantPerformanceHint::Type Worse = GetLevel(1.0f);
+	const ERadiantPerformanceHint::Type Better = GetLevel(0.8f);
+
+	ERadiantPerformanceHint::Type Target = PerformanceHint;
+	if (Worse > PerformanceHint)
+	{
+		Target = Worse;
+	}
+	else if (Better < PerformanceHint)
+	{
+		Target = Better;
+	}
+
+	if (Target == PerformanceHint)
+	{
+		PendingPerformanceHintTime = 0.0f;
+		return;
+	}
+
+	if (Target != PendingPerformanceHint)
+	{
+		PendingPerformanceHint = Target;
+		PendingPerformanceHintTime = 0.0f;
+	}
+
+	PendingPerformanceHintTime += InRealDeltaTime;
+
+	const float Delay = (Target > PerformanceHint) ? PerformanceHints.DegradeDelay : PerformanceHints.RecoverDelay;
+	if (PendingPerformanceHintTime >= Delay)
+	{
+		PerformanceHint = Target;
+		PendingPerformanceHintTime = 0.0f;
+		CallJavaScript("RadiantUI.PerformanceHint", FString(GetPerformanceHintName(PerformanceHint)));
+	}
 }
 
 void FRadiantWebView::TickTextureUpdate(float InRealTime, float InWorldTime, float InWorldDeltaTime, ERHIFeatureLevel::Type FeatureLevel)
@@ -684,6 +1016,11 @@ void FRadiantWebView::TickTextureUpdate(float InRealTime, float InWorldTime, flo
 				return;
 			}
 
+			if (IsWaitingForFence())
+			{
+				return;
+			}
+
 			UpdateTextureAndRedrawCanvas(InRealTime, InWorldTime, InWorldDeltaTime, FeatureLevel);
 			TextureUpdateTime = 0.0f;
 		}
@@ -712,6 +1049,8 @@ void FRadiantWebView::Repaint(int InNumRegions, const CefRuntimeRect* InRegions,
 		return;
 	}
 
+	const double PaintStartTime = FPlatformTime::Seconds();
+
 	// update the offscreen surface
 	const int BPP = 4;
 	const int SurfaceStride = InWidth * BPP;
@@ -735,10 +1074,81 @@ void FRadiantWebView::Repaint(int InNumRegions, const CefRuntimeRect* InRegions,
 
 	//ClearSurfaceToColor(FColor::Red);
 
+	PaintSecondsSinceTick += FPlatformTime::Seconds() - PaintStartTime;
 	bHasInitialFrame = true;
 	bTextureDirty = true;
 }
 
+void FRadiantWebView::FenceReached(int InSequence)
+{
+	// NOTE: called with CriticalSection entered, right after the Repaint.
+	PaintedFence = InSequence;
+
+	const double Now = FPlatformTime::Seconds();
+	int32 NumReached = 0;
+
+	while ((NumReached < PendingFences.Num()) && (PendingFences[NumReached].Sequence <= InSequence))
+	{
+		LastFenceLatency = (float)(Now - PendingFences[NumReached].SubmitTime);
+		++NumReached;
+	}
+
+	PendingFences.RemoveAt(0, NumReached, false);
+}
+
+int32 FRadiantWebView::SubmitFence()
+{
+	AcquireBrowser();
+	if (!WebView)
+	{
+		return INDEX_NONE;
+	}
+
+	FScopeLock L(&CriticalSection);
+
+	const double Now = FPlatformTime::Seconds();
+	DropExpiredFences(Now);
+
+	FSubmittedFence& Fence = PendingFences[PendingFences.AddUninitialized()];
+	Fence.Sequence = ++NextFence;
+	Fence.SubmitTime = Now;
+
+	WebView->InsertFence(Fence.Sequence);
+	return Fence.Sequence;
+}
+
+void FRadiantWebView::SetWaitForFences(bool bInWait, float InMaxWait)
+{
+	bWaitForFences = bInWait;
+	MaxFenceWait = InMaxWait;
+}
+
+bool FRadiantWebView::IsWaitingForFence()
+{
+	if (!bWaitForFences)
+	{
+		return false;
+	}
+
+	FScopeLock L(&CriticalSection);
+
+	DropExpiredFences(FPlatformTime::Seconds());
+	return PendingFences.Num() > 0;
+}
+
+void FRadiantWebView::DropExpiredFences(double InNow)
+{
+	// NOTE: called with CriticalSection entered.
+	// a hidden or reloading page never answers, give up on its fences after MaxFenceWait.
+	int32 NumExpired = 0;
+	while ((NumExpired < PendingFences.Num()) && ((InNow - PendingFences[NumExpired].SubmitTime) >= MaxFenceWait))
+	{
+		++NumExpired;
+	}
+
+	PendingFences.RemoveAt(0, NumExpired, false);
+}
+
 void FRadiantWebView::ClearSurfaceToColor(const FColor& InColor)
 {
 	int NumPixels = Size.X*Size.Y;
@@ -770,6 +1180,7 @@ void FRadiantWebView::UpdateTextureAndRedrawCanvas(float InRealTime, float InWor
 		});
 
 		bTextureDirty = false;
+		PresentedFence = PaintedFence;
 	}
 
 	RedrawCanvas(InRealTime, InWorldTime, InWorldDeltaTime, FeatureLevel);
@@ -849,13 +1260,189 @@ void FRadiantWebView::ExecuteJSHook_Callback(const char* InHookName, ICefRuntime
 	check(InArguments);
 
 	FString HookName(InHookName);
-	OnExecuteJSHook.Broadcast(HookName, InArguments);
+
+	FNativeHook* NativeHook = NativeHooks.Find(HookName);
+	if (NativeHook)
+	{
+		(*NativeHook)(InArguments);
+	}
+	else
+	{
+		OnExecuteJSHook.Broadcast(HookName, InArguments);
+	}
 }
 
 ICefStream* FRadiantWebView::GetFileStream(const char* FilePath)
 {
 	FString FullPath = FString::Printf(TEXT("%s%s"), *FPaths::ProjectContentDir(), *FString(FilePath));
-	return LoadFileToStream(FullPath);
+
+	const FFileStatData Stat = IFileManager::Get().GetStatData(*FullPath);
+	if (!Stat.bIsValid || Stat.bIsDirectory)
+	{
+		return nullptr;
+	}
+
+	if (FRadiantMappedFileStream::ShouldMap(Stat.FileSize))
+	{
+		// large assets start streaming at once instead of after a full read.
+		ICefStream* Mapped = FRadiantMappedFileStream::Open(FullPath);
+		if (Mapped)
+		{
+			return Mapped;
+		}
+	}
+
+	FRadiantContentBuffer Buffer = FRadiantContentCache::Get().Load(FullPath, Stat);
+	if (Buffer.IsValid())
+	{
+		return new FRadiantContentStream(Buffer);
+	}
+
+	return nullptr;
+}
+
+ICefDataStream* FRadiantWebView::CreateDataStream(const char* InChannel, const char* InQuery)
+{
+	FDataChannel Channel;
+	{
+		FScopeLock L(&CriticalSection);
+		const FDataChannel* Found = DataChannels.Find(FString(UTF8_TO_TCHAR(InChannel)));
+		if (!Found)
+		{
+			return nullptr;
+		}
+		Channel = *Found;
+	}
+
+	TSharedPtr<FRadiantDataStream, ESPMode::ThreadSafe> Stream = MakeShareable(new FRadiantDataStream(UTF8_TO_TCHAR(InChannel), UTF8_TO_TCHAR(InQuery), Channel.MimeType));
+	Stream->CefReference = Stream;
+
+	// held until the producer writes, so it can still pick the status and Cache-Control.
+	Stream->bHasHeaders = false;
+
+	FDataProducer Producer = Channel.Producer;
+	AsyncTask(ENamedThreads::GameThread, [Producer, Stream]()
+	{
+		if (!Stream->IsCancelled())
+		{
+			Producer(Stream.ToSharedRef());
+		}
+	});
+
+	return Stream.Get();
+}
+
+void FRadiantWebView::RegisterDataChannel(const FString& InChannel, const FString& InMimeType, FDataProducer InProducer)
+{
+	FDataChannel Channel;
+	Channel.MimeType = InMimeType;
+	Channel.Producer = MoveTemp(InProducer);
+
+	FScopeLock L(&CriticalSection);
+	DataChannels.Add(InChannel, MoveTemp(Channel));
+}
+
+void FRadiantWebView::UnregisterDataChannel(const FString& InChannel)
+{
+	FScopeLock L(&CriticalSection);
+	DataChannels.Remove(InChannel);
+}
+
+FString FRadiantWebView::GetApiRouteKey(const FString& InMethod, const FString& InPath)
+{
+	return InMethod.ToUpper() + TEXT(" ") + InPath;
+}
+
+ICefDataStream* FRadiantWebView::CreateApiStream(const char* InMethod, const char* InPath, const char* InQuery, const void* InBody, int InBodySize)
+{
+	TSharedPtr<FRadiantApiRequest> Request = MakeShareable(new FRadiantApiRequest());
+	Request->Method = UTF8_TO_TCHAR(InMethod);
+	Request->Path = UTF8_TO_TCHAR(InPath);
+	Request->Query = UTF8_TO_TCHAR(InQuery);
+
+	FApiRoute Route;
+	bool bFound = false;
+	{
+		FScopeLock L(&CriticalSection);
+
+		const FApiRoute* Found = ApiRoutes.Find(GetApiRouteKey(Request->Method, Request->Path));
+
+		// then the closest "/*" route above the path.
+		FString Parent = Request->Path;
+		int32 Slash;
+		while (!Found && Parent.FindLastChar(TEXT('/'), Slash))
+		{
+			Parent = Parent.Left(Slash);
+			Found = ApiRoutes.Find(GetApiRouteKey(Request->Method, Parent + TEXT("/*")));
+		}
+
+		if (Found)
+		{
+			Route = *Found;
+			bFound = true;
+		}
+	}
+
+	TSharedPtr<FRadiantDataStream, ESPMode::ThreadSafe> Stream = MakeShareable(new FRadiantDataStream(Request->Path, Request->Query, bFound ? Route.MimeType : TEXT("text/plain")));
+	Stream->CefReference = Stream;
+
+	if (!bFound)
+	{
+		Stream->Status = 404;
+		Stream->Write(TEXT("Not Found"));
+		Stream->Finish();
+		return Stream.Get();
+	}
+
+	// held until the handler responds.
+	Stream->bHasHeaders = false;
+
+	if (InBody && (InBodySize > 0))
+	{
+		Request->Body.Append((const uint8*)InBody, InBodySize);
+	}
+
+	FApiHandler Handler = Route.Handler;
+	AsyncTask(ENamedThreads::GameThread, [Handler, Request, Stream]()
+	{
+		if (!Stream->IsCancelled())
+		{
+			Handler(*Request, Stream.ToSharedRef());
+		}
+	});
+
+	return Stream.Get();
+}
+
+ICefDataStream* FRadiantWebView::CreateTextureStream(const char* InAssetPath, const char* InQuery)
+{
+	TSharedPtr<FRadiantDataStream, ESPMode::ThreadSafe> Stream = MakeShareable(new FRadiantDataStream(UTF8_TO_TCHAR(InAssetPath), UTF8_TO_TCHAR(InQuery), TEXT("image/png")));
+	Stream->CefReference = Stream;
+
+	// held until the texture cache has the image or knows there isn't one.
+	Stream->bHasHeaders = false;
+
+	int32 Size = 0;
+	FParse::Value(*Stream->GetQuery(), TEXT("size="), Size);
+
+	FRadiantTextureCache::Get().Serve(Stream.ToSharedRef(), Stream->GetChannel(), Size);
+	return Stream.Get();
+}
+
+void FRadiantWebView::RegisterApiHandler(const FString& InMethod, const FString& InPath, const FString& InMimeType, FApiHandler InHandler)
+{
+	FApiRoute Route;
+	Route.MimeType = InMimeType;
+	Route.Handler = MoveTemp(InHandler);
+
+	FScopeLock L(&CriticalSection);
+	ApiRoutes.Add(GetApiRouteKey(InMethod, InPath), MoveTemp(Route));
+}
+
+void FRadiantWebView::UnregisterApiHandler(const FString& InMethod, const FString& InPath)
+{
+	FScopeLock L(&CriticalSection);
+	ApiRoutes.Remove(GetApiRouteKey(InMethod, InPath));
 }
 
 // Called when the associated webview is being released.
@@ -864,6 +1451,7 @@ ICefStream* FRadiantWebView::GetFileStream(const char* FilePath)
 void FRadiantWebView::Release(ICefWebView *InWebView)
 {
 	WebView = nullptr;
+
 	bCreated = false;
 	bRunning = false;
 }
@@ -149,7 +149,7 @@ void ARadiantWebViewActor::CallJavaScriptFunction(const FString& HookName, UObje
 
 		if (WebView.IsValid())
 		{
-			ICefRuntimeVariantList* Arguments = FJavaScriptHelper::CreateVariantList(Parameters->GetClass(), Parameters, WebView->GetVariantFactory());
+			ICefRuntimeVariantList* Arguments = FJavaScriptHelper::CreateVariantList(Parameters->GetClass(), Parameters, WebView->GetVariantFactory(), FJavaScriptHelper::WantsNamedStructFields(Parameters));
 			FTCHARToUTF8 Convert(*HookName);
 			WebViewRenderComponent->WebView->CallJavaScriptFunction(Convert.Get(), Arguments);
 			if (Arguments)
@@ -160,6 +160,16 @@ void ARadiantWebViewActor::CallJavaScriptFunction(const FString& HookName, UObje
 	}
 }
 
+TSharedPtr<FRadiantWebView> ARadiantWebViewActor::GetJavaScriptWebView()
+{
+	if (WebViewRenderComponent)
+	{
+		return WebViewRenderComponent->WebView;
+	}
+
+	return nullptr;
+}
+
 void ARadiantWebViewActor::PreInitializeComponents()
 {
 	Super::PreInitializeComponents();
@@ -196,6 +206,7 @@ void ARadiantWebViewActor::StartRefresh()
 		InitDynamicMaterial();
 
 		WebViewRenderComponent->WebView->OnExecuteJSHook.AddUObject(this, &ARadiantWebViewActor::OnExecuteJSHook);
+		WebViewRenderComponent->WebView->OnExecuteJSCall.BindUObject(this, &ARadiantWebViewActor::OnExecuteJSCall);
 	}
 }
 
@@ -652,6 +663,11 @@ void ARadiantWebViewActor::OnExecuteJSHook(const FString& HookName, ICefRuntimeV
 	FJavaScriptHelper::ExecuteHook(this, HookName, Arguments);
 }
 
+ICefRuntimeVariant* ARadiantWebViewActor::OnExecuteJSCall(const FString& HookName, ICefRuntimeVariantList* Arguments, FString& OutError)
+{
+	return FJavaScriptHelper::ExecuteCall(this, HookName, Arguments, WebViewRenderComponent->WebView->GetVariantFactory(), OutError);
+}
+
 void ARadiantWebViewActor::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -0,0 +1,268 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIPrivatePCH.h"
+#include "JSCall.h"
+
+namespace
+{
+	uint32 HashPropertyValue(UProperty* Property, const void* Value, uint32 Crc);
+
+	uint32 HashSingleValue(UProperty* Property, const void* Value, uint32 Crc)
+	{
+		if (Property->PropertyFlags & CPF_IsPlainOldData)
+		{
+			return FCrc::MemCrc32(Value, Property->ElementSize, Crc);
+		}
+		else if (UStrProperty* StrProperty = Cast<UStrProperty>(Property))
+		{
+			const FString& String = StrProperty->GetPropertyValue(Value);
+			return FCrc::MemCrc32(*String, String.Len() * sizeof(TCHAR), Crc);
+		}
+		else if (UTextProperty* TextProperty = Cast<UTextProperty>(Property))
+		{
+			const FString& String = TextProperty->GetPropertyValue(Value).ToString();
+			return FCrc::MemCrc32(*String, String.Len() * sizeof(TCHAR), Crc);
+		}
+		else if (UArrayProperty* ArrayProperty = Cast<UArrayProperty>(Property))
+		{
+			FScriptArrayHelper Array(ArrayProperty, Value);
+			const int32 Num = Array.Num();
+			Crc = FCrc::MemCrc32(&Num, sizeof(Num), Crc);
+
+			if (ArrayProperty->Inner->PropertyFlags & CPF_IsPlainOldData)
+			{
+				return FCrc::MemCrc32(Array.GetRawPtr(), Num * ArrayProperty->Inner->ElementSize, Crc);
+			}
+
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Crc = HashPropertyValue(ArrayProperty->Inner, Array.GetRawPtr(i), Crc);
+			}
+
+			return Crc;
+		}
+		else if (UStructProperty* StructProperty = Cast<UStructProperty>(Property))
+		{
+			for (TFieldIterator<UProperty> It(StructProperty->Struct); It; ++It)
+			{
+				Crc = HashPropertyValue(*It, It->ContainerPtrToValuePtr<void>(Value), Crc);
+			}
+
+			return Crc;
+		}
+
+		// object references and the like: compare the pointer bits.
+		return FCrc::MemCrc32(Value, Property->ElementSize, Crc);
+	}
+
+	uint32 HashPropertyValue(UProperty* Property, const void* Value, uint32 Crc)
+	{
+		for (int32 i = 0; i < Property->ArrayDim; ++i)
+		{
+			Crc = HashSingleValue(Property, (const uint8*)Value + i * Property->ElementSize, Crc);
+		}
+
+		return Crc;
+	}
+
+	// Delegates can't be represented in JavaScript.
+	bool CanBindProperty(UProperty* Property)
+	{
+		return !Property->IsA<UDelegateProperty>() && !Property->IsA<UMulticastDelegateProperty>();
+	}
+}
+
+URadiantWebViewBindingComponent::URadiantWebViewBindingComponent(const FObjectInitializer& ObjectInitializer)
+: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// sample the game state after it has been updated this frame.
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+	bWantsInitializeComponent = true;
+	bAutoActivate = true;
+	Source = nullptr;
+	WatchedBindCount = 0;
+}
+
+void URadiantWebViewBindingComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	AActor* Owner = GetOwner();
+
+	if (!Source)
+	{
+		Source = Owner;
+	}
+
+	if (!Target && Owner && Owner->GetClass()->ImplementsInterface(URadiantJavaScriptFunctionCallTargetInterface::StaticClass()))
+	{
+		Target = TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface>(Owner);
+	}
+}
+
+void URadiantWebViewBindingComponent::SetBinding(UObject* InSource, TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface> InTarget)
+{
+	Source = InSource;
+	Target = InTarget;
+	Watched.Empty();
+	WatchedSource.Reset();
+}
+
+void URadiantWebViewBindingComponent::ResendAll()
+{
+	for (FWatchedProperty& Property : Watched)
+	{
+		Property.bSent = false;
+	}
+}
+
+void URadiantWebViewBindingComponent::BuildWatchedProperties()
+{
+	Watched.Empty();
+	WatchedSource = Source;
+
+	if (!Source)
+	{
+		return;
+	}
+
+	UClass* Class = Source->GetClass();
+
+	auto AddWatched = [this](UProperty* Property)
+	{
+		FWatchedProperty& NewWatched = Watched[Watched.AddDefaulted()];
+		NewWatched.Property = Property;
+		NewWatched.Hash = 0;
+		NewWatched.bSent = false;
+
+		FTCHARToUTF8 Convert(*Property->GetName());
+		NewWatched.Key.Append(Convert.Get(), Convert.Length() + 1);
+	};
+
+	if (Properties.Num() > 0)
+	{
+		for (const FName& Name : Properties)
+		{
+			UProperty* Property = FindField<UProperty>(Class, Name);
+			if (Property && CanBindProperty(Property))
+			{
+				AddWatched(Property);
+			}
+			else
+			{
+				UE_LOG(RadiantUILog, Warning, TEXT("%s: '%s' has no bindable property '%s'."), *GetName(), *Class->GetName(), *Name.ToString());
+			}
+		}
+	}
+	else
+	{
+		for (TFieldIterator<UProperty> It(Class, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+		{
+			if (CanBindProperty(*It))
+			{
+				AddWatched(*It);
+			}
+		}
+	}
+}
+
+bool URadiantWebViewBindingComponent::UpdateSnapshot(FWatchedProperty& InWatched, const void* InValue)
+{
+	UProperty* Property = InWatched.Property;
+
+	if (Property->PropertyFlags & CPF_IsPlainOldData)
+	{
+		const int32 Size = Property->ElementSize * Property->ArrayDim;
+		if (InWatched.bSent && (FMemory::Memcmp(InWatched.Snapshot.GetData(), InValue, Size) == 0))
+		{
+			return false;
+		}
+
+		InWatched.Snapshot.SetNumUninitialized(Size);
+		FMemory::Memcpy(InWatched.Snapshot.GetData(), InValue, Size);
+	}
+	else
+	{
+		const uint32 Hash = HashPropertyValue(Property, InValue, 0);
+		if (InWatched.bSent && (InWatched.Hash == Hash))
+		{
+			return false;
+		}
+
+		InWatched.Hash = Hash;
+	}
+
+	InWatched.bSent = true;
+	return true;
+}
+
+void URadiantWebViewBindingComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!Source || Channel.IsEmpty() || !Target)
+	{
+		return;
+	}
+
+	TSharedPtr<FRadiantWebView> WebView = Target->GetJavaScriptWebView();
+	if (!WebView.IsValid() || !WebView->IsRunning())
+	{
+		return;
+	}
+
+	if (WatchedSource.Get() != Source)
+	{
+		BuildWatchedProperties();
+	}
+
+	// a new WebView has an empty page state, and so does a page that has just bound the
+	// channel, whether it is new or reloaded.
+	const int32 BindCount = WebView->GetStateBindCount(Channel);
+	if ((WatchedWebView.Pin() != WebView) || (WatchedBindCount != BindCount))
+	{
+		WatchedWebView = WebView;
+		WatchedBindCount = BindCount;
+		ResendAll();
+	}
+
+	ICefRuntimeVariantFactory* VariantFactory = WebView->GetVariantFactory();
+	ICefRuntimeVariantDictionary* Patch = nullptr;
+
+	for (FWatchedProperty& Property : Watched)
+	{
+		void* Value = Property.Property->ContainerPtrToValuePtr<void>(Source);
+		if (!UpdateSnapshot(Property, Value))
+		{
+			continue;
+		}
+
+		if (!Patch)
+		{
+			Patch = VariantFactory->CreateDictionary();
+		}
+
+		ICefRuntimeVariant* Variant = FJavaScriptHelper::CreateVariant(Property.Property, Value, VariantFactory);
+		if (!Variant)
+		{
+			// empty arrays don't translate to a value, but must still clear the page's copy.
+			Variant = Property.Property->IsA<UArrayProperty>() ? static_cast<ICefRuntimeVariant*>(VariantFactory->CreateList(0)) : VariantFactory->CreateNull();
+		}
+
+		Patch->SetValue(Property.Key.GetData(), Variant);
+		Variant->Release();
+	}
+
+	if (Patch)
+	{
+		ICefRuntimeVariantList* Arguments = VariantFactory->CreateList(1);
+		Arguments->SetValue(0, Patch);
+		Patch->Release();
+
+		FTCHARToUTF8 Convert(*Channel);
+		WebView->CallJavaScriptFunction(Convert.Get(), Arguments);
+		Arguments->Release();
+	}
+}
@@ -574,6 +574,7 @@ void URadiantWebViewHUDElement::PostInitProperties()
 	{
 		WebView = MakeShareable(new FRadiantWebView(DefaultSettings));
 		WebView->OnExecuteJSHook.AddUObject(this, &URadiantWebViewHUDElement::OnExecuteJSHook);
+		WebView->OnExecuteJSCall.BindUObject(this, &URadiantWebViewHUDElement::OnExecuteJSCall);
 	}
 }
 
@@ -697,7 +698,7 @@ void URadiantWebViewHUDElement::CallJavaScriptFunction(const FString& HookName,
 	{
 		if (Parameters)
 		{
-			ICefRuntimeVariantList* Arguments = FJavaScriptHelper::CreateVariantList(Parameters->GetClass(), Parameters, WebView->GetVariantFactory());
+			ICefRuntimeVariantList* Arguments = FJavaScriptHelper::CreateVariantList(Parameters->GetClass(), Parameters, WebView->GetVariantFactory(), FJavaScriptHelper::WantsNamedStructFields(Parameters));
 			FTCHARToUTF8 Convert(*HookName);
 			WebView->CallJavaScriptFunction(Convert.Get(), Arguments);
 			if (Arguments)
@@ -718,6 +719,11 @@ void URadiantWebViewHUDElement::OnExecuteJSHook(const FString& HookName, ICefRun
 	FJavaScriptHelper::ExecuteHook(this, HookName, Arguments);
 }
 
+ICefRuntimeVariant* URadiantWebViewHUDElement::OnExecuteJSCall(const FString& HookName, ICefRuntimeVariantList* Arguments, FString& OutError)
+{
+	return FJavaScriptHelper::ExecuteCall(this, HookName, Arguments, WebView->GetVariantFactory(), OutError);
+}
+
 TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface> URadiantWebViewHUDElement::GetJavaScriptCallContext()
 {
 	return TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface>(this);
@@ -0,0 +1,94 @@
+// Copyright 2014 Joseph Riedel, Inc. All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "../../../CefRuntime/API/CEFRuntimeAPI.hpp"
+
+// A game://api/<path> request as seen by an FRadiantWebView::FApiHandler.
+struct FRadiantApiRequest
+{
+	FString Method;
+	// Including the leading '/'.
+	FString Path;
+	FString Query;
+	TArray<uint8> Body;
+
+	FString GetBodyAsString() const;
+};
+
+// Response body for a game://data/<channel> or game://api/<path> request, filled in by the
+// producer registered with FRadiantWebView::RegisterDataChannel or RegisterApiHandler.
+//
+// Each Write() is handed to the page as soon as it reads, so large payloads can be produced
+// over several frames (or from a worker thread) and parsed incrementally with fetch()/XHR.
+// Writing is thread-safe. The response ends with Finish().
+//
+// The headers are held until Respond() picks the status, the first Write() or Finish()
+// answers 200 with the channel's or handler's default MIME type.
+class RADIANTUI_API FRadiantDataStream : public ICefDataStream, public TSharedFromThis<FRadiantDataStream, ESPMode::ThreadSafe>
+{
+public:
+
+	FRadiantDataStream(const FString& InChannel, const FString& InQuery, const FString& InMimeType);
+
+	// The data channel name, or the path of an API request.
+	const FString& GetChannel() const { return Channel; }
+	const FString& GetQuery() const { return Query; }
+
+	// Sends the response headers. Ignored once they have been sent.
+	void Respond(int32 InStatus, const FString& InMimeType);
+	// Sends a complete response.
+	void Respond(int32 InStatus, const FString& InMimeType, const FString& InBody);
+
+	// Cache-Control header sent with the response, the default is no-store. Must be set
+	// before the headers are sent.
+	void SetCacheControl(const FString& InCacheControl);
+
+	void Write(const void* InData, int32 InSize);
+	// Writes InText as UTF-8.
+	void Write(const FString& InText);
+	void Finish();
+
+	// Bytes written but not yet read by the page, for producers that want to throttle.
+	int32 GetBufferedSize();
+
+	// The page stopped reading (navigated away or aborted the request), further writes are dropped.
+	bool IsCancelled() const { return bCancelled; }
+
+	// Begin ICefDataStream interface, called from the CEF IO thread.
+	virtual void Release() override;
+	virtual bool HasHeaders() override;
+	virtual int GetStatus() override;
+	virtual const char* GetMimeType() override;
+	virtual const char* GetCacheControl() override;
+	virtual int Read(void* OutBuffer, int InMaxBytes) override;
+	virtual void SetListener(ICefDataStreamListener* InListener) override;
+	virtual void Cancel() override;
+	// End ICefDataStream interface.
+
+private:
+
+	friend class FRadiantWebView;
+
+	void NotifyListener();
+	void SetMimeType(const FString& InMimeType);
+
+	FString Channel;
+	FString Query;
+	TArray<ANSICHAR> MimeType;
+	TArray<ANSICHAR> CacheControl;
+	int32 Status;
+
+	FCriticalSection CriticalSection;
+	TArray<uint8> Buffer;
+	int32 ReadOffset;
+	ICefDataStreamListener* Listener;
+	bool bListenerWaiting;
+	bool bHasHeaders;
+	bool bFinished;
+	FThreadSafeBool bCancelled;
+
+	// Reference held on behalf of CEF until Release().
+	TSharedPtr<FRadiantDataStream, ESPMode::ThreadSafe> CefReference;
+};
@@ -16,6 +16,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category=JavaScript)
 	FString FunctionName;
 
+	// Pass struct parameters to JavaScript as objects keyed by field name instead of positional arrays.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category=JavaScript)
+	bool bNamedStructFields;
+
 	UFUNCTION(BlueprintCallable, Category=JavaScript)
 	void Invoke(const TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface>& Context);
 };
\ No newline at end of file
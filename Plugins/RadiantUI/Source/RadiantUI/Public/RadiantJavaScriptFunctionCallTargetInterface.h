@@ -5,6 +5,8 @@
 
 #include "RadiantJavaScriptFunctionCallTargetInterface.generated.h"
 
+class FRadiantWebView;
+
 UINTERFACE(Blueprintable, BlueprintType)
 class RADIANTUI_API URadiantJavaScriptFunctionCallTargetInterface : public UInterface
 {
@@ -16,4 +18,7 @@ class IRadiantJavaScriptFunctionCallTargetInterface
 	GENERATED_IINTERFACE_BODY()
 
 	virtual void CallJavaScriptFunction(const FString& HookName, UObject* Parameters) = 0;
+
+	// The WebView calls are sent to, for callers that build their own arguments.
+	virtual TSharedPtr<FRadiantWebView> GetJavaScriptWebView();
 };
\ No newline at end of file
@@ -6,3 +6,5 @@
 #include "Core.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(RadiantUILog, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("RadiantUI"), STATGROUP_RadiantUI, STATCAT_Advanced);
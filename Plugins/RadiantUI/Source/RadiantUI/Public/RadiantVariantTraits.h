@@ -0,0 +1,269 @@
+// Copyright 2014 Joseph Riedel, Inc. All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "../../../CefRuntime/API/CEFJavaScriptAPI.hpp"
+#include "Templates/IntegerSequence.h"
+#include "Templates/Tuple.h"
+
+// Compile-time conversions between C++ values and JavaScript variants, used by
+// FRadiantWebView::BindHook and FRadiantWebView::CallJavaScript.
+//
+// Decode() returns false if the variant can't be converted to T.
+// Encode() returns a new variant reference owned by the caller.
+template <typename T>
+struct TRadiantVariantTraits;
+
+template <>
+struct TRadiantVariantTraits<bool>
+{
+	static bool Decode(ICefRuntimeVariant* Variant, bool& OutValue)
+	{
+		if (Variant->IsBool())
+		{
+			OutValue = static_cast<ICefRuntimeVariantBool*>(Variant)->GetValue();
+			return true;
+		}
+
+		return false;
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, bool Value)
+	{
+		return Factory->CreateBool(Value);
+	}
+};
+
+// JavaScript numbers arrive as either int or double variants depending on their value.
+template <typename T>
+struct TRadiantNumericVariantTraits
+{
+	static bool Decode(ICefRuntimeVariant* Variant, T& OutValue)
+	{
+		if (Variant->IsInt())
+		{
+			OutValue = (T)static_cast<ICefRuntimeVariantInt*>(Variant)->GetValue();
+			return true;
+		}
+		else if (Variant->IsDouble())
+		{
+			OutValue = (T)static_cast<ICefRuntimeVariantDouble*>(Variant)->GetValue();
+			return true;
+		}
+
+		return false;
+	}
+};
+
+template <typename T>
+struct TRadiantIntegerVariantTraits : public TRadiantNumericVariantTraits<T>
+{
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, T Value)
+	{
+		return Factory->CreateInt((int)Value);
+	}
+};
+
+template <typename T>
+struct TRadiantFloatVariantTraits : public TRadiantNumericVariantTraits<T>
+{
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, T Value)
+	{
+		return Factory->CreateDouble((double)Value);
+	}
+};
+
+template <> struct TRadiantVariantTraits<int32> : public TRadiantIntegerVariantTraits<int32> {};
+template <> struct TRadiantVariantTraits<uint32> : public TRadiantIntegerVariantTraits<uint32> {};
+template <> struct TRadiantVariantTraits<uint8> : public TRadiantIntegerVariantTraits<uint8> {};
+template <> struct TRadiantVariantTraits<float> : public TRadiantFloatVariantTraits<float> {};
+template <> struct TRadiantVariantTraits<double> : public TRadiantFloatVariantTraits<double> {};
+
+template <>
+struct TRadiantVariantTraits<FString>
+{
+	static bool Decode(ICefRuntimeVariant* Variant, FString& OutValue)
+	{
+		if (Variant->IsString())
+		{
+			OutValue = UTF8_TO_TCHAR(static_cast<ICefRuntimeVariantString*>(Variant)->GetValue());
+			return true;
+		}
+
+		return false;
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, const FString& Value)
+	{
+		return Factory->CreateString(TCHAR_TO_UTF8(*Value));
+	}
+};
+
+template <>
+struct TRadiantVariantTraits<FName>
+{
+	static bool Decode(ICefRuntimeVariant* Variant, FName& OutValue)
+	{
+		if (Variant->IsString())
+		{
+			OutValue = FName(UTF8_TO_TCHAR(static_cast<ICefRuntimeVariantString*>(Variant)->GetValue()));
+			return true;
+		}
+
+		return false;
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, const FName& Value)
+	{
+		return Factory->CreateString(TCHAR_TO_UTF8(*Value.ToString()));
+	}
+};
+
+template <>
+struct TRadiantVariantTraits<FText>
+{
+	static bool Decode(ICefRuntimeVariant* Variant, FText& OutValue)
+	{
+		if (Variant->IsString())
+		{
+			OutValue = FText::FromString(UTF8_TO_TCHAR(static_cast<ICefRuntimeVariantString*>(Variant)->GetValue()));
+			return true;
+		}
+
+		return false;
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, const FText& Value)
+	{
+		return Factory->CreateString(TCHAR_TO_UTF8(*Value.ToString()));
+	}
+};
+
+// Arrays travel as lists, except float and byte arrays which travel as a single
+// blob (an ArrayBuffer in JavaScript).
+template <typename T>
+struct TRadiantListVariantTraits
+{
+	static bool Decode(ICefRuntimeVariant* Variant, TArray<T>& OutValue)
+	{
+		if (!Variant->IsList())
+		{
+			return false;
+		}
+
+		ICefRuntimeVariantList* List = static_cast<ICefRuntimeVariantList*>(Variant);
+		const int ListSize = List->GetSize();
+
+		OutValue.SetNum(ListSize);
+
+		for (int i = 0; i < ListSize; ++i)
+		{
+			if (!TRadiantVariantTraits<T>::Decode(List->GetValue(i), OutValue[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, const TArray<T>& Value)
+	{
+		ICefRuntimeVariantList* List = Factory->CreateList(Value.Num());
+
+		for (int32 i = 0; i < Value.Num(); ++i)
+		{
+			ICefRuntimeVariant* Element = TRadiantVariantTraits<T>::Encode(Factory, Value[i]);
+			List->SetValue(i, Element);
+			Element->Release();
+		}
+
+		return List;
+	}
+};
+
+template <typename T>
+struct TRadiantBlobVariantTraits
+{
+	static bool Decode(ICefRuntimeVariant* Variant, TArray<T>& OutValue)
+	{
+		if (Variant->IsBlob())
+		{
+			ICefRuntimeVariantBlob* Blob = static_cast<ICefRuntimeVariantBlob*>(Variant);
+			if ((Blob->GetSize() % sizeof(T)) != 0)
+			{
+				return false;
+			}
+
+			OutValue.SetNumUninitialized((int32)(Blob->GetSize() / sizeof(T)));
+			FMemory::Memcpy(OutValue.GetData(), Blob->GetData(), Blob->GetSize());
+			return true;
+		}
+
+		return TRadiantListVariantTraits<T>::Decode(Variant, OutValue);
+	}
+
+	static ICefRuntimeVariant* Encode(ICefRuntimeVariantFactory* Factory, const TArray<T>& Value)
+	{
+		return Factory->CreateBlob(Value.GetData(), Value.Num() * sizeof(T));
+	}
+};
+
+template <typename T>
+struct TRadiantVariantTraits<TArray<T>> : public TRadiantListVariantTraits<T> {};
+
+template <> struct TRadiantVariantTraits<TArray<float>> : public TRadiantBlobVariantTraits<float> {};
+template <> struct TRadiantVariantTraits<TArray<uint8>> : public TRadiantBlobVariantTraits<uint8> {};
+
+namespace RadiantVariantTraits
+{
+	template <typename... ArgTypes, uint32... Indices>
+	bool DecodeArguments(ICefRuntimeVariantList* Arguments, TTuple<ArgTypes...>& OutValues, TIntegerSequence<uint32, Indices...>)
+	{
+		bool bDecoded = true;
+		int Expand[] = { 0, (bDecoded = bDecoded && TRadiantVariantTraits<ArgTypes>::Decode(Arguments->GetValue(Indices), OutValues.template Get<Indices>()), 0)... };
+		(void)Expand;
+		return bDecoded;
+	}
+
+	template <typename FunctorType, typename... ArgTypes, uint32... Indices>
+	void Invoke(FunctorType& Functor, TTuple<ArgTypes...>& Values, TIntegerSequence<uint32, Indices...>)
+	{
+		Functor(Values.template Get<Indices>()...);
+	}
+
+	// Converts an argument list to ArgTypes... and calls Functor. Returns false on a count or type mis-match.
+	template <typename... ArgTypes, typename FunctorType>
+	bool Apply(FunctorType& Functor, ICefRuntimeVariantList* Arguments)
+	{
+		const int NumArguments = Arguments ? Arguments->GetSize() : 0;
+		if (NumArguments != (int)sizeof...(ArgTypes))
+		{
+			return false;
+		}
+
+		TTuple<typename TDecay<ArgTypes>::Type...> Values;
+		if (!DecodeArguments(Arguments, Values, TMakeIntegerSequence<uint32, sizeof...(ArgTypes)>()))
+		{
+			return false;
+		}
+
+		Invoke(Functor, Values, TMakeIntegerSequence<uint32, sizeof...(ArgTypes)>());
+		return true;
+	}
+
+	inline void EncodeArguments(ICefRuntimeVariantFactory* Factory, ICefRuntimeVariantList* List, int Index)
+	{
+	}
+
+	template <typename ArgType, typename... ArgTypes>
+	void EncodeArguments(ICefRuntimeVariantFactory* Factory, ICefRuntimeVariantList* List, int Index, const ArgType& Arg, const ArgTypes&... Args)
+	{
+		ICefRuntimeVariant* Variant = TRadiantVariantTraits<typename TDecay<ArgType>::Type>::Encode(Factory, Arg);
+		List->SetValue(Index, Variant);
+		Variant->Release();
+
+		EncodeArguments(Factory, List, Index + 1, Args...);
+	}
+}
@@ -5,11 +5,16 @@
 
 #include "RadiantCanvasRenderTarget.h"
 #include "../../../CefRuntime/API/CEFJavaScriptAPI.hpp"
+#include "RadiantVariantTraits.h"
 #include "RadiantLogCategories.h"
 #include "RadiantWebView.generated.h"
 
 class ICefWebView;
 class ICefStream;
+class ICefSharedState;
+class ICefDataStream;
+class FRadiantDataStream;
+struct FRadiantApiRequest;
 struct CefRuntimeRect;
 
 UENUM()
@@ -22,6 +27,17 @@ namespace ERadiantWebViewCursor
 	};
 }
 
+UENUM(BlueprintType)
+namespace ERadiantPerformanceHint
+{
+	enum Type
+	{
+		Full,
+		Reduced,
+		Minimal
+	};
+}
+
 USTRUCT(BlueprintType)
 struct RADIANTUI_API FRadiantWebViewCursor
 {
@@ -53,6 +69,46 @@ struct RADIANTUI_API FRadiantWebViewCursorSet
 	FRadiantWebViewCursor Hover;
 };
 
+// When to ask pages to cut back on effects, see RadiantUI.onPerformanceHint.
+// Times are in milliseconds per game frame.
+USTRUCT(BlueprintType)
+struct RADIANTUI_API FRadiantPerformanceHintSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance)
+	bool bEnabled;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance)
+	float ReducedFrameTime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance)
+	float MinimalFrameTime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance, meta=(Tooltip="Time spent copying this view's paints into its texture."))
+	float ReducedPaintTime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance)
+	float MinimalPaintTime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance, meta=(Tooltip="Seconds a worse level must persist before pages are told."))
+	float DegradeDelay;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Performance, meta=(Tooltip="Seconds a better level must persist before pages are told."))
+	float RecoverDelay;
+
+	FRadiantPerformanceHintSettings()
+	{
+		bEnabled = true;
+		ReducedFrameTime = 22.0f;
+		MinimalFrameTime = 40.0f;
+		ReducedPaintTime = 2.0f;
+		MinimalPaintTime = 5.0f;
+		DegradeDelay = 0.5f;
+		RecoverDelay = 3.0f;
+	}
+};
+
 USTRUCT(BlueprintType)
 struct RADIANTUI_API FRadiantWebViewDefaultSettings
 {
@@ -67,9 +123,15 @@ struct RADIANTUI_API FRadiantWebViewDefaultSettings
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Settings)
 	float RefreshRate;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings, meta=(Tooltip="If true the game tick drives RadiantUI.requestAnimationFrame, at most RefreshRate times a second."))
+	uint32 bGameDrivenAnimation:1;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings)
 	FString URL;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings, meta=(Tooltip="A [RadiantUI] RequestContexts profile name. Views in the same profile share an HTTP cache and cookies, empty uses the default profile."))
+	FString RequestContext;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings)
 	FColor InitialCanvasColor;
 
@@ -79,11 +141,15 @@ struct RADIANTUI_API FRadiantWebViewDefaultSettings
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings)
 	FRadiantWebViewCursorSet Cursors;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Settings)
+	FRadiantPerformanceHintSettings PerformanceHints;
+
 	FRadiantWebViewDefaultSettings()
 	{
 		Size = FIntPoint(1024, 1024);
 		bTransparentRendering = false;
 		RefreshRate = 30.0f;
+		bGameDrivenAnimation = false;
 		InitialCanvasColor = FColor(0, 0, 0, 0);
 		bProjectedCursor = true;
 		URL = TEXT("http://www.unrealengine.com");
@@ -103,6 +169,11 @@ public:
 	// Invoked from JavaScript to Run Game Function
 	FOnExecuteJSHook OnExecuteJSHook;
 
+	DECLARE_DELEGATE_RetVal_ThreeParams(ICefRuntimeVariant*, FOnExecuteJSCall, const FString&, ICefRuntimeVariantList*, FString&);
+	// Invoked by RadiantUI.Call(). Returns the result the promise resolves with (a new reference),
+	// or null and an error message to reject it.
+	FOnExecuteJSCall OnExecuteJSCall;
+
 	// Only valid if Start() or PreCreateTexture() have been called.
 	UTexture2D* WebViewTexture;
 	URadiantCanvasRenderTarget* WebViewCanvas;
@@ -120,6 +191,16 @@ public:
 
 	bool IsTransparentRendering() { return bTransparentRendering; }
 
+	// Sends RadiantUI.requestAnimationFrame its frames from Tick() instead of leaving pages on
+	// Chromium's own timer.
+	void SetGameDrivenAnimation(bool bInGameDriven) { bGameDrivenAnimation = bInGameDriven; }
+	bool IsGameDrivenAnimation() { return bGameDrivenAnimation; }
+
+	// The level last pushed to RadiantUI.onPerformanceHint, chosen from game frame time and
+	// this view's paint cost.
+	ERadiantPerformanceHint::Type GetPerformanceHint() { return PerformanceHint; }
+	void SetPerformanceHintSettings(const FRadiantPerformanceHintSettings& InSettings) { PerformanceHints = InSettings; }
+
 	bool SetCursorPosition(const FVector2D& CursorPosition);
 	FVector2D GetCursorPosition() { return CursorPosition; }
 
@@ -142,6 +223,102 @@ public:
 	ICefRuntimeVariantFactory* GetVariantFactory();
 	void CallJavaScriptFunction(const char* InHookName, ICefRuntimeVariantList* InArguments);
 
+	// Calls a JavaScript hook with arguments converted through TRadiantVariantTraits.
+	template <typename... ArgTypes>
+	void CallJavaScript(const char* InHookName, const ArgTypes&... Args)
+	{
+		ICefRuntimeVariantFactory* Factory = GetVariantFactory();
+		if (Factory)
+		{
+			ICefRuntimeVariantList* Arguments = Factory->CreateList(sizeof...(ArgTypes));
+			RadiantVariantTraits::EncodeArguments(Factory, Arguments, 0, Args...);
+			CallJavaScriptFunction(InHookName, Arguments);
+			Arguments->Release();
+		}
+	}
+
+	// Binds a JavaScript hook directly to a C++ function. Arguments are converted at compile time
+	// from the hook parameters and the call bypasses UFunction dispatch (OnExecuteJSHook is not
+	// broadcast for bound hooks).
+	//
+	//	WebView->BindHook(TEXT("Health"), this, &UMyHUD::OnHealth);
+	//	WebView->BindHook(TEXT("Ammo"), [this](int32 Ammo, int32 Clip) { ... });
+	template <typename UserClass, typename... ArgTypes>
+	void BindHook(const FString& InHookName, UserClass* InObject, void (UserClass::*InMethod)(ArgTypes...))
+	{
+		TWeakObjectPtr<UserClass> WeakObject(InObject);
+		BindHook(InHookName, [WeakObject, InMethod](ArgTypes... Args)
+		{
+			if (UserClass* Object = WeakObject.Get())
+			{
+				(Object->*InMethod)(Args...);
+			}
+		});
+	}
+
+	template <typename FunctorType>
+	void BindHook(const FString& InHookName, FunctorType&& InFunctor)
+	{
+		BindHookFunctor(InHookName, Forward<FunctorType>(InFunctor), &TDecay<FunctorType>::Type::operator());
+	}
+
+	void UnbindHook(const FString& InHookName);
+
+	typedef TFunction<void(const TSharedRef<FRadiantDataStream, ESPMode::ThreadSafe>&)> FDataProducer;
+
+	// Serves game://data/<Channel>. InProducer runs on the game thread for every request and
+	// writes the response into the stream, immediately or over time from any thread.
+	//
+	//	WebView->RegisterDataChannel(TEXT("inventory"), TEXT("application/json"), [this](const TSharedRef<FRadiantDataStream, ESPMode::ThreadSafe>& Stream) { ... });
+	void RegisterDataChannel(const FString& InChannel, const FString& InMimeType, FDataProducer InProducer);
+	void UnregisterDataChannel(const FString& InChannel);
+
+	typedef TFunction<void(const FRadiantApiRequest&, const TSharedRef<FRadiantDataStream, ESPMode::ThreadSafe>&)> FApiHandler;
+
+	// Serves InMethod requests to game://api<InPath>. A path ending in "/*" also matches
+	// everything below it. InHandler runs on the game thread and may answer later from any
+	// thread with FRadiantDataStream::Respond(), unmatched requests answer 404.
+	//
+	//	WebView->RegisterApiHandler(TEXT("POST"), TEXT("/inventory/equip"), TEXT("application/json"), [this](const FRadiantApiRequest& Request, const TSharedRef<FRadiantDataStream, ESPMode::ThreadSafe>& Response) { ... });
+	void RegisterApiHandler(const FString& InMethod, const FString& InPath, const FString& InMimeType, FApiHandler InHandler);
+	void UnregisterApiHandler(const FString& InMethod, const FString& InPath);
+
+	// Receives a script's value, or null and the reason it failed. Runs on the game thread.
+	typedef TFunction<void(ICefRuntimeVariant*, const FString&)> FScriptCompleted;
+
+	// Runs InSource in the page. A single expression yields its value, a list of statements
+	// yields what it returns.
+	//
+	//	WebView->ExecuteScript(TEXT("document.title"), [](ICefRuntimeVariant* Result, const FString& Error) { ... });
+	void ExecuteScript(const FString& InSource, FScriptCompleted InCompleted = FScriptCompleted());
+
+	// For snippets that run often: the page compiles InSource once per script context and
+	// reuses it for every ExecuteCompiledScript() with the returned handle.
+	int32 CompileScript(const FString& InSource);
+	void ExecuteCompiledScript(int32 InScript, FScriptCompleted InCompleted = FScriptCompleted());
+
+	// Ends a batch of CallJavaScript() updates and returns its sequence number. GetPaintedFence()
+	// reaches it once the page has painted the batch, GetPresentedFence() once that paint is in
+	// the texture.
+	int32 SubmitFence();
+	int32 GetPaintedFence() { return PaintedFence; }
+	int32 GetPresentedFence() { return PresentedFence; }
+
+	// Seconds from SubmitFence() to the paint that showed the batch, for the latest fence.
+	float GetLastFenceLatency() { return LastFenceLatency; }
+
+	// Holds texture uploads while a submitted fence hasn't painted, for at most InMaxWait
+	// seconds, so a batch is never presented half applied.
+	void SetWaitForFences(bool bInWait, float InMaxWait = 0.1f);
+
+	// Typed fields pages can poll with RadiantUI.ReadState() without per-update messages.
+	// Null until the browser has been created.
+	ICefSharedState* GetSharedState();
+
+	// Number of times the page has called RadiantUI.BindState() for InChannel. A change means
+	// the page (re)bound it, after a reload for instance, and needs the whole state again.
+	int32 GetStateBindCount(const FString& InChannel) const;
+
 	void Tick(float InRealTime, float InWorldTime, float InWorldDeltaTime, ERHIFeatureLevel::Type FeatureLevel);
 	
 	ICefWebView* GetBrowser();
@@ -153,15 +330,15 @@ private:
 
 	struct FQueuedCallback
 	{
-		FQueuedCallback() : Arguments(nullptr) {}
+		FQueuedCallback() : Arguments(nullptr), CallId(INDEX_NONE), QueuedTime(0.0) {}
 		
 		FQueuedCallback(const FQueuedCallback& Other) : Arguments(nullptr)
 		{
 			*this = Other;
 		}
 
-		FQueuedCallback(const FString& InHookName, ICefRuntimeVariantList* InArguments)
-		: HookName(InHookName), Arguments(InArguments)
+		FQueuedCallback(const FString& InHookName, ICefRuntimeVariantList* InArguments, int32 InCallId = INDEX_NONE)
+		: HookName(InHookName), Arguments(InArguments), CallId(InCallId), QueuedTime(0.0)
 		{
 			if (Arguments)
 			{
@@ -180,6 +357,9 @@ private:
 		FQueuedCallback& operator = (const FQueuedCallback& Other)
 		{
 			HookName = Other.HookName;
+			CallId = Other.CallId;
+			Timing = Other.Timing;
+			QueuedTime = Other.QueuedTime;
 
 			if (Arguments)
 			{
@@ -198,13 +378,79 @@ private:
 
 		FString HookName;
 		ICefRuntimeVariantList* Arguments;
+		// RadiantUI.Call() request id, INDEX_NONE for hooks.
+		int32 CallId;
+		// only set for hooks sent while hook timing is on.
+		CefRuntimeHookTiming Timing;
+		double QueuedTime;
+	};
+
+	typedef TFunction<void(ICefRuntimeVariantList*)> FNativeHook;
+
+	template <typename FunctorType, typename LambdaType, typename... ArgTypes>
+	void BindHookFunctor(const FString& InHookName, FunctorType&& InFunctor, void (LambdaType::*)(ArgTypes...) const)
+	{
+		BindTypedHook<ArgTypes...>(InHookName, Forward<FunctorType>(InFunctor));
+	}
+
+	template <typename FunctorType, typename LambdaType, typename... ArgTypes>
+	void BindHookFunctor(const FString& InHookName, FunctorType&& InFunctor, void (LambdaType::*)(ArgTypes...))
+	{
+		BindTypedHook<ArgTypes...>(InHookName, Forward<FunctorType>(InFunctor));
+	}
+
+	template <typename... ArgTypes, typename FunctorType>
+	void BindTypedHook(const FString& InHookName, FunctorType&& InFunctor)
+	{
+		FString HookName(InHookName);
+		typename TDecay<FunctorType>::Type Functor(Forward<FunctorType>(InFunctor));
+		NativeHooks.Add(InHookName, [HookName, Functor](ICefRuntimeVariantList* Arguments) mutable
+		{
+			if (!RadiantVariantTraits::Apply<ArgTypes...>(Functor, Arguments))
+			{
+				UE_LOG(RadiantUILog, Error, TEXT("JavaScript Hook Function '%s' was called with arguments that do not match its %d bound parameters."), *HookName, (int32)sizeof...(ArgTypes));
+			}
+		});
+	}
+
+	struct FDataChannel
+	{
+		FString MimeType;
+		FDataProducer Producer;
+	};
+
+	struct FApiRoute
+	{
+		FString MimeType;
+		FApiHandler Handler;
+	};
+
+	static FString GetApiRouteKey(const FString& InMethod, const FString& InPath);
+
+	struct FCompiledScript
+	{
+		FString Source;
+		// ICefWebView::CompileScript handle, 0 until first run in the current browser.
+		int BrowserHandle;
 	};
 
+	TArray<FCompiledScript> CompiledScripts;
+	int32 CompiledGeneration;
+	// bumped for every browser created.
+	volatile int32 BrowserGeneration;
+
 	TArray<FQueuedCallback> PendingCallbacks;
+	TMap<FString, FNativeHook> NativeHooks;
+	TMap<FString, int32> StateBindCounts;
+	// read from the CEF IO thread, guarded by CriticalSection.
+	TMap<FString, FDataChannel> DataChannels;
+	// keyed by "METHOD /path", guarded by CriticalSection.
+	TMap<FString, FApiRoute> ApiRoutes;
 	FRadiantWebViewCursor* MouseCursor;
 	ICefWebView* volatile WebView;
 
 	FString URL;
+	FString RequestContext;
 	FIntPoint Size;
 	FVector2D CursorPosition;
 	FColor InitialCanvasColor;
@@ -224,6 +470,40 @@ private:
 	volatile int NumPendingRenderCommands;
 	float TextureUpdateTime;
 	float RefreshRate;
+	bool bGameDrivenAnimation;
+	float AnimationFrameTime;
+	float LastRealTime;
+	int32 AnimationFrameNumber;
+
+	FRadiantPerformanceHintSettings PerformanceHints;
+	ERadiantPerformanceHint::Type PerformanceHint;
+	ERadiantPerformanceHint::Type PendingPerformanceHint;
+	float PendingPerformanceHintTime;
+	float FrameTimeAverage;
+	float PaintTimeAverage;
+	// guarded by CriticalSection.
+	double PaintSecondsSinceTick;
+
+	struct FSubmittedFence
+	{
+		int32 Sequence;
+		double SubmitTime;
+	};
+
+	// fences in flight and their submit times, guarded by CriticalSection.
+	TArray<FSubmittedFence> PendingFences;
+	int32 NextFence;
+	volatile int32 PaintedFence;
+	int32 PresentedFence;
+	float LastFenceLatency;
+	bool bWaitForFences;
+	float MaxFenceWait;
+
+	// RadiantUI.HookTiming as last applied to WebView.
+	bool bHookTiming;
+
+	bool IsWaitingForFence();
+	void DropExpiredFences(double InNow);
 
 	//ENQUEUE_RENDER_COMMAND(FQueueUpdateTextureCmd)(
 	//	[WebView](FRHICommandListImmediate& RHICmdList)
@@ -251,6 +531,9 @@ private:
 	void CreateWebView();
 	void AcquireBrowser();
 	void FlushRenderUpdates();
+	void TickAnimationFrame(float InRealTime, float InRealDeltaTime, float InWorldTime, float InWorldDeltaTime);
+	void TickPerformanceHint(float InRealDeltaTime);
+	static const TCHAR* GetPerformanceHintName(ERadiantPerformanceHint::Type InHint);
 	void TickTextureUpdate(float InRealTime, float InWorldTime, float InWorldDeltaTime, ERHIFeatureLevel::Type FeatureLevel);
 	void UpdateTextureAndRedrawCanvas(float InRealTime, float InWorldTime, float InWorldDeltaTime, ERHIFeatureLevel::Type FeatureLevel);
 	void ClearSurfaceToColor(const FColor& InColor);
@@ -259,7 +542,10 @@ private:
 	void BlitWebViewToRenderTarget();
 	void BlitCursor();
 	void ProcessPendingCallbacks();
-	void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments);
+	void ExecuteJSHook(const char* InHookName, ICefRuntimeVariantList* InArguments, const CefRuntimeHookTiming* InTiming);
+	void JSHookDelivered(const char* InHookName, const CefRuntimeHookTiming& InTiming);
+	void ExecuteJSCall(int InCallId, const char* InName, ICefRuntimeVariantList* InArguments);
+	void DispatchJSCall(const FQueuedCallback& InCall);
 
 	// Begin ICefWebViewCallbacks Interface
 	void WebViewCreated(ICefWebView* InWebView);
@@ -267,6 +553,9 @@ private:
 	// Called when regions in the webview are rendered.
 	void Repaint(int InNumRegions, const CefRuntimeRect* InRegions, const void* InBuffer, int InWidth, int InHeight);
 
+	// Called after the Repaint that first shows the fence's batch.
+	void FenceReached(int InSequence);
+
 	// Called when the cursor changes
 	void OnCursorChange(void* InPlatformCursorHandle);
 
@@ -279,6 +568,15 @@ private:
 	// Open a file (if it exists).
 	ICefStream* GetFileStream(const char* FilePath);
 
+	// Open a game://data/ stream (if the channel is registered).
+	ICefDataStream* CreateDataStream(const char* InChannel, const char* InQuery);
+
+	// Answer a game://api/ request.
+	ICefDataStream* CreateApiStream(const char* InMethod, const char* InPath, const char* InQuery, const void* InBody, int InBodySize);
+
+	// Answer a game://texture/ request, see FRadiantTextureCache.
+	ICefDataStream* CreateTextureStream(const char* InAssetPath, const char* InQuery);
+
 	// When the associated webview is being released.
 	// If there are no more references to the ICefWebViewCallbacks 
 	// object it should be destroyed by the owner.
@@ -147,6 +147,7 @@ public:
 	virtual void RegisterMeshComponent(UMeshComponent* InMeshComponent);
 
 	virtual void CallJavaScriptFunction(const FString& HookName, UObject* Parameters) override;
+	virtual TSharedPtr<FRadiantWebView> GetJavaScriptWebView() override;
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -201,6 +202,7 @@ private:
 	void SyncMouseState(bool InClearButtons, bool InFocus);
 	bool TraceScreenPoint(APawn* InPawn, FVector2D& OutUV);
 	void OnExecuteJSHook(const FString& HookName, ICefRuntimeVariantList* Arguments);
+	ICefRuntimeVariant* OnExecuteJSCall(const FString& HookName, ICefRuntimeVariantList* Arguments, FString& OutError);
 
 	int32 ModifierKeyState;
 	int32 ModifierKeyExState;
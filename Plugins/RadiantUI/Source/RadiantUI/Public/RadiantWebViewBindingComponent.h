@@ -0,0 +1,80 @@
+// Copyright 2014 Joseph Riedel, Inc. All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "RadiantJavaScriptFunctionCallTargetInterface.h"
+#include "RadiantWebViewBindingComponent.generated.h"
+
+class FRadiantWebView;
+
+// Mirrors UPROPERTYs of a game object into a plain JavaScript object.
+//
+// Each tick the watched properties are compared to what was last sent and only the
+// fields that changed are pushed, as a single dictionary argument to the Channel hook.
+// Nothing is sent while the values are unchanged, and everything is sent again whenever
+// the page binds the channel. Pages apply the patches with:
+//
+//	var player = RadiantUI.BindState('PlayerState', {});
+//
+// Binding the same object again replaces its previous onChange handler rather than adding
+// another, and RadiantUI.UnbindState('PlayerState', player) stops the updates.
+UCLASS(ClassGroup = "RadiantUI", meta = (BlueprintSpawnableComponent))
+class RADIANTUI_API URadiantWebViewBindingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	URadiantWebViewBindingComponent(const FObjectInitializer& ObjectInitializer);
+
+	// JavaScript hook that receives the patches.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Binding")
+	FString Channel;
+
+	// Properties to watch on Source. If empty, every property declared by Source's class is watched.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Binding")
+	TArray<FName> Properties;
+
+	// Object to watch. Defaults to the owning actor.
+	UPROPERTY(transient, BlueprintReadOnly, Category = "Binding")
+	UObject* Source;
+
+	// Where patches are sent. Defaults to the owning actor if it is a call target.
+	UPROPERTY(transient, BlueprintReadOnly, Category = "Binding")
+	TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface> Target;
+
+	UFUNCTION(BlueprintCallable, Category = "Binding")
+	void SetBinding(UObject* InSource, TScriptInterface<IRadiantJavaScriptFunctionCallTargetInterface> InTarget);
+
+	// Sends every watched field on the next tick, e.g. after the page was reloaded.
+	UFUNCTION(BlueprintCallable, Category = "Binding")
+	void ResendAll();
+
+	// Begin UActorComponent interface.
+	virtual void InitializeComponent() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	// End UActorComponent interface.
+
+private:
+
+	struct FWatchedProperty
+	{
+		UProperty* Property;
+		// UTF-8 property name, used as the patch key.
+		TArray<ANSICHAR> Key;
+		// Last sent value for plain old data, compared with memcmp.
+		TArray<uint8> Snapshot;
+		// Last sent value hash for everything else (strings, arrays, structs).
+		uint32 Hash;
+		bool bSent;
+	};
+
+	TArray<FWatchedProperty> Watched;
+	TWeakObjectPtr<UObject> WatchedSource;
+	TWeakPtr<FRadiantWebView> WatchedWebView;
+	int32 WatchedBindCount;
+
+	void BuildWatchedProperties();
+	bool UpdateSnapshot(FWatchedProperty& InWatched, const void* InValue);
+};
@@ -152,6 +152,7 @@ public:
 	//void ForceFocus(APlayerController *Owner);
 
 	virtual void CallJavaScriptFunction(const FString& HookName, UObject* Parameters) override;
+	virtual TSharedPtr<FRadiantWebView> GetJavaScriptWebView() override { return WebView; }
 
 	// Begin UObject Interface
 	virtual void PostInitProperties() override;
@@ -165,6 +166,7 @@ private:
 
 	void SetSlateVisibility();
 	void OnExecuteJSHook(const FString& HookName, ICefRuntimeVariantList* Arguments);
+	ICefRuntimeVariant* OnExecuteJSCall(const FString& HookName, ICefRuntimeVariantList* Arguments, FString& OutError);
 	
 	friend class ARadiantWebViewHUD;
 
@@ -38,6 +38,8 @@ namespace UnrealBuildTool.Rules
 				new string[]
 				{
 					"InputCore",
+					"ImageWrapper",
+					"AssetRegistry",
                     "RenderCore",
                     "UtilityShaders",
                     // "ShaderCore",
@@ -0,0 +1,13 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIEditorPrivatePCH.h"
+#include "RadiantUIBundleCommandlet.h"
+#include "RadiantUIBundler.h"
+
+int32 URadiantUIBundleCommandlet::Main(const FString& Params)
+{
+	FString Source;
+	const bool bSucceeded = FParse::Value(*Params, TEXT("source="), Source) ? FRadiantUIBundler::Bundle(Source) : FRadiantUIBundler::BundleAll();
+	return bSucceeded ? 0 : 1;
+}
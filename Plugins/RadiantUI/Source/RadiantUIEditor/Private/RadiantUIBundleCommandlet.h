@@ -0,0 +1,20 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "RadiantUIBundleCommandlet.generated.h"
+
+// Bundles web UI content without a full cook, see FRadiantUIBundler.
+// Usage: UE4Editor-Cmd <Project> -run=RadiantUIBundle [-source=<Content subdirectory>]
+// Without -source every [RadiantUI] ContentArchives entry is bundled.
+UCLASS()
+class URadiantUIBundleCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual int32 Main(const FString& Params) override;
+};
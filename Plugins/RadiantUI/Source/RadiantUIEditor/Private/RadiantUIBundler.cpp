@@ -0,0 +1,765 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIEditorPrivatePCH.h"
+#include "RadiantUIBundler.h"
+
+namespace
+{
+	// must match ContentArchives::MANIFEST_NAME in CEFRuntime.
+	const TCHAR* ManifestName = TEXT("radiantui-manifest.json");
+
+	// hex digits of the content hash put in bundle file names.
+	const int32 NameHashBytes = 8;
+
+	FString HashToString(const TArray<uint8>& InData, int32 InBytes = 20)
+	{
+		uint8 Hash[20];
+		FSHA1::HashBuffer(InData.GetData(), InData.Num(), Hash);
+		return BytesToHex(Hash, InBytes).ToLower();
+	}
+
+	FString BytesToString(const TArray<uint8>& InData)
+	{
+		int32 Start = 0;
+		if ((InData.Num() >= 3) && (InData[0] == 0xEF) && (InData[1] == 0xBB) && (InData[2] == 0xBF))
+		{
+			// utf-8 byte order mark.
+			Start = 3;
+		}
+
+		FUTF8ToTCHAR Converted((const ANSICHAR*)InData.GetData() + Start, InData.Num() - Start);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	TArray<uint8> StringToBytes(const FString& InString)
+	{
+		FTCHARToUTF8 Converted(*InString);
+
+		TArray<uint8> Bytes;
+		Bytes.Append((const uint8*)Converted.Get(), Converted.Length());
+		return Bytes;
+	}
+
+	bool IsWhitespace(const FString& InString)
+	{
+		for (TCHAR Char : InString)
+		{
+			if (!FChar::IsWhitespace(Char))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// drops comments and collapses whitespace, leaving strings alone.
+	FString MinifyCSS(const FString& InCSS)
+	{
+		FString Out;
+		Out.Reserve(InCSS.Len());
+
+		bool bPendingSpace = false;
+		for (int32 i = 0; i < InCSS.Len(); ++i)
+		{
+			const TCHAR Char = InCSS[i];
+
+			if ((Char == TEXT('/')) && (i + 1 < InCSS.Len()) && (InCSS[i + 1] == TEXT('*')))
+			{
+				const int32 End = InCSS.Find(TEXT("*/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i + 2);
+				i = (End == INDEX_NONE) ? InCSS.Len() : End + 1;
+				bPendingSpace = true;
+				continue;
+			}
+
+			if (FChar::IsWhitespace(Char))
+			{
+				bPendingSpace = true;
+				continue;
+			}
+
+			static const TCHAR* Separators = TEXT("{};,");
+			const bool bSeparator = FCString::Strchr(Separators, Char) != nullptr;
+
+			if (bPendingSpace && !bSeparator && (Out.Len() > 0) && !FCString::Strchr(Separators, Out[Out.Len() - 1]))
+			{
+				Out.AppendChar(TEXT(' '));
+			}
+			bPendingSpace = false;
+
+			if ((Char == TEXT('"')) || (Char == TEXT('\'')))
+			{
+				int32 End = i + 1;
+				while ((End < InCSS.Len()) && (InCSS[End] != Char))
+				{
+					End += (InCSS[End] == TEXT('\\')) ? 2 : 1;
+				}
+
+				End = FMath::Min(End, InCSS.Len() - 1);
+				Out += InCSS.Mid(i, End - i + 1);
+				i = End;
+				continue;
+			}
+
+			Out.AppendChar(Char);
+		}
+
+		return Out;
+	}
+
+	// index just past the literal starting at InStart: a quoted string, a template literal
+	// (including any ${} expressions in it) or a regular expression.
+	int32 SkipJSLiteral(const FString& InJS, int32 InStart)
+	{
+		const TCHAR Quote = InJS[InStart];
+		bool bInClass = false;
+
+		int32 i = InStart + 1;
+		while (i < InJS.Len())
+		{
+			const TCHAR Char = InJS[i];
+
+			if (Char == TEXT('\\'))
+			{
+				i += 2;
+				continue;
+			}
+
+			// strings and regular expressions can't span lines, stop at the break rather
+			// than swallow the rest of a broken file.
+			if ((Char == TEXT('\n')) && (Quote != TEXT('`')))
+			{
+				return i;
+			}
+
+			if ((Quote == TEXT('`')) && (Char == TEXT('$')) && (i + 1 < InJS.Len()) && (InJS[i + 1] == TEXT('{')))
+			{
+				// copy the expression as is, minding braces and literals inside it.
+				int32 Depth = 0;
+				i += 2;
+				while ((i < InJS.Len()) && ((InJS[i] != TEXT('}')) || (Depth > 0)))
+				{
+					const TCHAR ExpressionChar = InJS[i];
+					if ((ExpressionChar == TEXT('"')) || (ExpressionChar == TEXT('\'')) || (ExpressionChar == TEXT('`')))
+					{
+						i = SkipJSLiteral(InJS, i);
+						continue;
+					}
+
+					Depth += (ExpressionChar == TEXT('{')) ? 1 : ((ExpressionChar == TEXT('}')) ? -1 : 0);
+					++i;
+				}
+
+				++i;
+				continue;
+			}
+
+			if (Quote == TEXT('/'))
+			{
+				if (Char == TEXT('['))
+				{
+					bInClass = true;
+				}
+				else if (Char == TEXT(']'))
+				{
+					bInClass = false;
+				}
+				else if ((Char == TEXT('/')) && !bInClass)
+				{
+					return i + 1;
+				}
+			}
+			else if (Char == Quote)
+			{
+				return i + 1;
+			}
+
+			++i;
+		}
+
+		return InJS.Len();
+	}
+
+	// a '/' starts a regular expression rather than a division when it can't follow a value.
+	bool IsJSRegexStart(const FString& InOut)
+	{
+		int32 End = InOut.Len();
+		while ((End > 0) && FChar::IsWhitespace(InOut[End - 1]))
+		{
+			--End;
+		}
+
+		if (End == 0)
+		{
+			return true;
+		}
+
+		const TCHAR Previous = InOut[End - 1];
+		if (FChar::IsAlnum(Previous) || (Previous == TEXT('_')) || (Previous == TEXT('$')))
+		{
+			int32 Start = End;
+			while ((Start > 0) && (FChar::IsAlnum(InOut[Start - 1]) || (InOut[Start - 1] == TEXT('_')) || (InOut[Start - 1] == TEXT('$'))))
+			{
+				--Start;
+			}
+
+			static const TCHAR* Keywords[] = { TEXT("return"), TEXT("typeof"), TEXT("instanceof"), TEXT("in"), TEXT("of"), TEXT("new"), TEXT("delete"), TEXT("void"), TEXT("throw"), TEXT("case"), TEXT("do"), TEXT("else"), TEXT("yield"), TEXT("await") };
+			const FString Word = InOut.Mid(Start, End - Start);
+			for (const TCHAR* Keyword : Keywords)
+			{
+				if (Word.Equals(Keyword, ESearchCase::CaseSensitive))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		return FCString::Strchr(TEXT("(,=:[!&|?{};+-*%<>~^"), Previous) != nullptr;
+	}
+
+	// drops comments, indentation, trailing whitespace and blank lines, and collapses runs of
+	// spaces. strings, template literals and regular expressions are copied untouched and
+	// line breaks are kept, so automatic semicolon insertion is unaffected.
+	FString MinifyJS(const FString& InPath, const FString& InJS)
+	{
+		if (InPath.Contains(TEXT(".min.")))
+		{
+			return InJS;
+		}
+
+		FString Out;
+		Out.Reserve(InJS.Len());
+
+		bool bLineStart = true;
+		bool bPendingSpace = false;
+		bool bPendingBreak = false;
+
+		auto Emit = [&Out, &bLineStart, &bPendingSpace, &bPendingBreak](const TCHAR* InText, int32 InLength)
+		{
+			if (bPendingBreak)
+			{
+				Out.AppendChar(TEXT('\n'));
+			}
+			else if (bPendingSpace && !bLineStart)
+			{
+				Out.AppendChar(TEXT(' '));
+			}
+
+			Out.AppendChars(InText, InLength);
+			bLineStart = false;
+			bPendingSpace = false;
+			bPendingBreak = false;
+		};
+
+		int32 i = 0;
+		while (i < InJS.Len())
+		{
+			const TCHAR Char = InJS[i];
+			const TCHAR Next = (i + 1 < InJS.Len()) ? InJS[i + 1] : 0;
+
+			if ((Char == TEXT('\n')) || (Char == TEXT('\r')))
+			{
+				bPendingBreak = bPendingBreak || !bLineStart;
+				bLineStart = true;
+				bPendingSpace = false;
+				++i;
+			}
+			else if (FChar::IsWhitespace(Char))
+			{
+				bPendingSpace = true;
+				++i;
+			}
+			else if ((Char == TEXT('/')) && (Next == TEXT('/')))
+			{
+				const int32 End = InJS.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i);
+				i = (End == INDEX_NONE) ? InJS.Len() : End;
+			}
+			else if ((Char == TEXT('/')) && (Next == TEXT('*')))
+			{
+				const int32 End = InJS.Find(TEXT("*/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i + 2);
+				const int32 CommentEnd = (End == INDEX_NONE) ? InJS.Len() : End + 2;
+
+				// licence comments stay, and a comment spanning lines still separates them.
+				if ((i + 2 < InJS.Len()) && (InJS[i + 2] == TEXT('!')))
+				{
+					Emit(&InJS[i], CommentEnd - i);
+				}
+				else if (InJS.Mid(i, CommentEnd - i).Contains(TEXT("\n")))
+				{
+					bPendingBreak = bPendingBreak || !bLineStart;
+					bLineStart = true;
+				}
+				else
+				{
+					bPendingSpace = true;
+				}
+
+				i = CommentEnd;
+			}
+			else if ((Char == TEXT('"')) || (Char == TEXT('\'')) || (Char == TEXT('`')) || ((Char == TEXT('/')) && IsJSRegexStart(Out)))
+			{
+				const int32 End = SkipJSLiteral(InJS, i);
+				Emit(&InJS[i], End - i);
+				i = End;
+			}
+			else
+			{
+				Emit(&InJS[i], 1);
+				++i;
+			}
+		}
+
+		return Out + TEXT("\n");
+	}
+
+	// attribute names lower case, values unquoted.
+	TMap<FString, FString> ParseAttributes(const FString& InTag)
+	{
+		TMap<FString, FString> Attributes;
+
+		int32 i = 1;
+		while ((i < InTag.Len()) && !FChar::IsWhitespace(InTag[i]) && (InTag[i] != TEXT('>')))
+		{
+			++i;
+		}
+
+		for (;;)
+		{
+			while ((i < InTag.Len()) && (FChar::IsWhitespace(InTag[i]) || (InTag[i] == TEXT('/'))))
+			{
+				++i;
+			}
+
+			if ((i >= InTag.Len()) || (InTag[i] == TEXT('>')))
+			{
+				break;
+			}
+
+			const int32 NameStart = i;
+			while ((i < InTag.Len()) && !FChar::IsWhitespace(InTag[i]) && (InTag[i] != TEXT('=')) && (InTag[i] != TEXT('>')) && (InTag[i] != TEXT('/')))
+			{
+				++i;
+			}
+
+			const FString Name = InTag.Mid(NameStart, i - NameStart).ToLower();
+			FString Value;
+
+			if ((i < InTag.Len()) && (InTag[i] == TEXT('=')))
+			{
+				++i;
+				if ((i < InTag.Len()) && ((InTag[i] == TEXT('"')) || (InTag[i] == TEXT('\''))))
+				{
+					const TCHAR Quote = InTag[i++];
+					const int32 ValueStart = i;
+					while ((i < InTag.Len()) && (InTag[i] != Quote))
+					{
+						++i;
+					}
+					Value = InTag.Mid(ValueStart, i - ValueStart);
+					++i;
+				}
+				else
+				{
+					const int32 ValueStart = i;
+					while ((i < InTag.Len()) && !FChar::IsWhitespace(InTag[i]) && (InTag[i] != TEXT('>')))
+					{
+						++i;
+					}
+					Value = InTag.Mid(ValueStart, i - ValueStart);
+				}
+			}
+
+			Attributes.Add(Name, Value);
+		}
+
+		return Attributes;
+	}
+
+	// resolves a page relative URL to an archive path, empty if it isn't a local file.
+	FString ResolveURL(const FString& InPage, const FString& InURL)
+	{
+		if (InURL.IsEmpty() || InURL.Contains(TEXT(":")) || InURL.StartsWith(TEXT("/")) || InURL.Contains(TEXT("?")) || InURL.Contains(TEXT("#")))
+		{
+			return FString();
+		}
+
+		FString Path = FPaths::GetPath(InPage);
+		Path = Path.IsEmpty() ? InURL : (Path / InURL);
+		Path.ReplaceInline(TEXT("\\"), TEXT("/"));
+
+		if (!FPaths::CollapseRelativeDirectories(Path) || Path.StartsWith(TEXT("..")))
+		{
+			return FString();
+		}
+
+		Path.RemoveFromStart(TEXT("./"));
+		return Path;
+	}
+
+	enum class EAssetKind
+	{
+		Script,
+		Style
+	};
+
+	// a <script src> or <link rel="stylesheet"> that can be bundled.
+	struct FAssetTag
+	{
+		EAssetKind Kind;
+		int32 Begin;
+		int32 End;
+		FString Path;
+	};
+
+	void WriteUInt16(TArray<uint8>& Out, uint32 InValue)
+	{
+		Out.Add(InValue & 0xFF);
+		Out.Add((InValue >> 8) & 0xFF);
+	}
+
+	void WriteUInt32(TArray<uint8>& Out, uint32 InValue)
+	{
+		WriteUInt16(Out, InValue & 0xFFFF);
+		WriteUInt16(Out, InValue >> 16);
+	}
+}
+
+FRadiantUIBundler::FRadiantUIBundler(const FString& InSource)
+: Source(InSource)
+, SourceDir(FPaths::ProjectContentDir() / InSource)
+, InlineLimit(4096)
+{
+	GConfig->GetInt(TEXT("RadiantUI"), TEXT("BundleInlineLimit"), InlineLimit, GGameIni);
+	GConfig->GetArray(TEXT("RadiantUI"), TEXT("BundleExcludes"), Excludes, GGameIni);
+
+	if (Excludes.Num() == 0)
+	{
+		// Edge Animate sources and logs aren't needed at runtime.
+		Excludes.Add(TEXT("*.an"));
+		Excludes.Add(TEXT("*.ansym"));
+		Excludes.Add(TEXT("*.log"));
+	}
+}
+
+bool FRadiantUIBundler::Bundle(const FString& InSource)
+{
+	FRadiantUIBundler Bundler(InSource);
+	return Bundler.Run();
+}
+
+bool FRadiantUIBundler::BundleAll()
+{
+	TArray<FString> Archives;
+	GConfig->GetArray(TEXT("RadiantUI"), TEXT("ContentArchives"), Archives, GGameIni);
+
+	bool bSucceeded = true;
+	for (const FString& Name : Archives)
+	{
+		bSucceeded &= Bundle(Name);
+	}
+
+	return bSucceeded;
+}
+
+bool FRadiantUIBundler::Run()
+{
+	if (!AddSourceFiles())
+	{
+		UE_LOG(RadiantUIEditorLog, Error, TEXT("Nothing to bundle in %s."), *SourceDir);
+		return false;
+	}
+
+	TArray<FString> Pages;
+	for (const TPair<FString, TArray<uint8>>& File : Files)
+	{
+		const FString Extension = FPaths::GetExtension(File.Key).ToLower();
+		if ((Extension == TEXT("html")) || (Extension == TEXT("htm")))
+		{
+			Pages.Add(File.Key);
+		}
+	}
+
+	for (const FString& Page : Pages)
+	{
+		BundlePage(Page);
+	}
+
+	// keys are sorted so the same sources always produce the same archive.
+	Files.KeySort(TLess<FString>());
+
+	FString Manifest = TEXT("{\"version\":1,\"files\":{");
+	bool bFirst = true;
+	for (const TPair<FString, TArray<uint8>>& File : Files)
+	{
+		Manifest += FString::Printf(TEXT("%s\n\"%s\":\"%s\""), bFirst ? TEXT("") : TEXT(","), *File.Key.ReplaceCharWithEscapedChar(), *HashToString(File.Value));
+		bFirst = false;
+	}
+	Manifest += TEXT("\n}}\n");
+
+	Files.Add(ManifestName, StringToBytes(Manifest));
+
+	const FString ArchivePath = FPaths::ProjectContentDir() / Source + TEXT(".zip");
+	if (!WriteArchive(ArchivePath))
+	{
+		UE_LOG(RadiantUIEditorLog, Error, TEXT("Couldn't write %s."), *ArchivePath);
+		return false;
+	}
+
+	UE_LOG(RadiantUIEditorLog, Log, TEXT("Bundled %d pages, %d files from %s into %s."), Pages.Num(), Files.Num(), *SourceDir, *ArchivePath);
+	return true;
+}
+
+bool FRadiantUIBundler::AddSourceFiles()
+{
+	TArray<FString> Found;
+	IFileManager::Get().FindFilesRecursive(Found, *SourceDir, TEXT("*"), true, false);
+
+	for (const FString& Path : Found)
+	{
+		FString Relative = Path;
+		if (!FPaths::MakePathRelativeTo(Relative, *(SourceDir + TEXT("/"))))
+		{
+			continue;
+		}
+
+		Relative.ReplaceInline(TEXT("\\"), TEXT("/"));
+
+		const FString Filename = FPaths::GetCleanFilename(Relative);
+		if (Excludes.ContainsByPredicate([&Filename](const FString& Pattern) { return Filename.MatchesWildcard(Pattern); }))
+		{
+			continue;
+		}
+
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *Path))
+		{
+			UE_LOG(RadiantUIEditorLog, Warning, TEXT("Couldn't read %s, it won't be bundled."), *Path);
+			continue;
+		}
+
+		Files.Add(Relative, MoveTemp(Data));
+	}
+
+	return Files.Num() > 0;
+}
+
+void FRadiantUIBundler::BundlePage(const FString& InPage)
+{
+	const FString Html = BytesToString(Files.FindChecked(InPage));
+	const FString PageDir = FPaths::GetPath(InPage);
+
+	TArray<FAssetTag> Tags;
+
+	for (int32 i = Html.Find(TEXT("<")); i != INDEX_NONE; i = Html.Find(TEXT("<"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i + 1))
+	{
+		if (Html.Mid(i, 4) == TEXT("<!--"))
+		{
+			// commented out tags stay as they are.
+			i = Html.Find(TEXT("-->"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i + 4);
+			if (i == INDEX_NONE)
+			{
+				break;
+			}
+			continue;
+		}
+
+		const bool bScript = Html.Mid(i, 7).Equals(TEXT("<script"), ESearchCase::IgnoreCase);
+		const bool bStyle = Html.Mid(i, 6).Equals(TEXT("<style"), ESearchCase::IgnoreCase);
+		const bool bLink = Html.Mid(i, 5).Equals(TEXT("<link"), ESearchCase::IgnoreCase);
+		if (!bScript && !bStyle && !bLink)
+		{
+			continue;
+		}
+
+		const int32 TagEnd = Html.Find(TEXT(">"), ESearchCase::CaseSensitive, ESearchDir::FromStart, i);
+		if (TagEnd == INDEX_NONE)
+		{
+			break;
+		}
+
+		const TMap<FString, FString> Attributes = ParseAttributes(Html.Mid(i, TagEnd - i + 1));
+
+		if (bLink)
+		{
+			const FString* Rel = Attributes.Find(TEXT("rel"));
+			const FString* Href = Attributes.Find(TEXT("href"));
+			const FString* Media = Attributes.Find(TEXT("media"));
+			const FString Path = Href ? ResolveURL(InPage, *Href) : FString();
+
+			// stylesheets from other directories would need their url()s rebased.
+			if (Rel && Rel->Equals(TEXT("stylesheet"), ESearchCase::IgnoreCase) && (!Media || Media->Equals(TEXT("all"), ESearchCase::IgnoreCase)) &&
+				!Path.IsEmpty() && Files.Contains(Path) && (FPaths::GetPath(Path) == PageDir))
+			{
+				Tags.Add({ EAssetKind::Style, i, TagEnd + 1, Path });
+			}
+
+			i = TagEnd;
+			continue;
+		}
+
+		const TCHAR* CloseTag = bScript ? TEXT("</script") : TEXT("</style");
+		const int32 Close = Html.Find(CloseTag, ESearchCase::IgnoreCase, ESearchDir::FromStart, TagEnd);
+		const int32 CloseEnd = (Close != INDEX_NONE) ? Html.Find(TEXT(">"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Close) : INDEX_NONE;
+		if (CloseEnd == INDEX_NONE)
+		{
+			break;
+		}
+
+		if (bScript)
+		{
+			const FString* Src = Attributes.Find(TEXT("src"));
+			const FString* Type = Attributes.Find(TEXT("type"));
+			const FString Path = Src ? ResolveURL(InPage, *Src) : FString();
+
+			// async and deferred scripts run out of order, modules have their own scope.
+			const bool bClassic = !Type || Type->Equals(TEXT("text/javascript"), ESearchCase::IgnoreCase) || Type->Equals(TEXT("application/javascript"), ESearchCase::IgnoreCase);
+			if (bClassic && !Attributes.Contains(TEXT("async")) && !Attributes.Contains(TEXT("defer")) &&
+				!Path.IsEmpty() && Files.Contains(Path) && IsWhitespace(Html.Mid(TagEnd + 1, Close - TagEnd - 1)))
+			{
+				Tags.Add({ EAssetKind::Script, i, CloseEnd + 1, Path });
+			}
+		}
+
+		// never look for tags inside a script or style body.
+		i = CloseEnd;
+	}
+
+	if (Tags.Num() == 0)
+	{
+		return;
+	}
+
+	// replaced back to front so earlier offsets stay valid.
+	FString Out = Html;
+	int32 RunEnd = Tags.Num() - 1;
+
+	for (int32 RunStart = Tags.Num() - 1; RunStart >= 0; --RunStart)
+	{
+		const bool bJoinsPrevious = (RunStart > 0) && (Tags[RunStart - 1].Kind == Tags[RunStart].Kind) &&
+			IsWhitespace(Html.Mid(Tags[RunStart - 1].End, Tags[RunStart].Begin - Tags[RunStart - 1].End));
+		if (bJoinsPrevious)
+		{
+			continue;
+		}
+
+		const EAssetKind Kind = Tags[RunStart].Kind;
+
+		FString Contents;
+		for (int32 j = RunStart; j <= RunEnd; ++j)
+		{
+			const FString Text = BytesToString(Files.FindChecked(Tags[j].Path));
+			if (Kind == EAssetKind::Script)
+			{
+				// a file missing its final semicolon mustn't run into the next one.
+				Contents += MinifyJS(Tags[j].Path, Text) + TEXT(";\n");
+			}
+			else
+			{
+				Contents += MinifyCSS(Text) + TEXT("\n");
+			}
+		}
+
+		const TCHAR* CloseTag = (Kind == EAssetKind::Script) ? TEXT("</script") : TEXT("</style");
+		const bool bInline = (FTCHARToUTF8(*Contents).Length() <= InlineLimit) &&
+			!Contents.Contains(CloseTag, ESearchCase::IgnoreCase) && !Contents.Contains(TEXT("<!--"));
+
+		FString Replacement;
+		if (Kind == EAssetKind::Script)
+		{
+			Replacement = bInline ?
+				FString::Printf(TEXT("<script>%s</script>"), *Contents) :
+				FString::Printf(TEXT("<script src=\"%s\"></script>"), *AddBundle(InPage, TEXT("js"), Contents));
+		}
+		else
+		{
+			Replacement = bInline ?
+				FString::Printf(TEXT("<style>%s</style>"), *Contents) :
+				FString::Printf(TEXT("<link rel=\"stylesheet\" href=\"%s\">"), *AddBundle(InPage, TEXT("css"), Contents));
+		}
+
+		Out = Out.Left(Tags[RunStart].Begin) + Replacement + Out.Mid(Tags[RunEnd].End);
+		RunEnd = RunStart - 1;
+	}
+
+	Files.Add(InPage, StringToBytes(Out));
+}
+
+FString FRadiantUIBundler::AddBundle(const FString& InPage, const FString& InExtension, const FString& InContents)
+{
+	TArray<uint8> Data = StringToBytes(InContents);
+
+	// named by content, the runtime can cache it forever and a new build gets a new URL.
+	const FString Name = FString::Printf(TEXT("%s.%s.%s"), *FPaths::GetBaseFilename(InPage), *HashToString(Data, NameHashBytes), *InExtension);
+	const FString PageDir = FPaths::GetPath(InPage);
+
+	Files.Add(PageDir.IsEmpty() ? Name : (PageDir / Name), MoveTemp(Data));
+	return Name;
+}
+
+bool FRadiantUIBundler::WriteArchive(const FString& InPath) const
+{
+	// stored, not deflated: the runtime keeps the archive in memory and serves entries
+	// in place, and most of the size is already minified.
+	const uint32 Flags = 1 << 11; // utf-8 names
+	const uint32 DosTime = 0;
+	const uint32 DosDate = (1 << 5) | 1; // 1980-01-01, so rebuilds are byte identical.
+
+	TArray<uint8> Zip;
+	TArray<uint8> Directory;
+
+	for (const TPair<FString, TArray<uint8>>& File : Files)
+	{
+		const FTCHARToUTF8 Name(*File.Key);
+		const uint32 Crc = FCrc::MemCrc32(File.Value.GetData(), File.Value.Num());
+		const uint32 Offset = Zip.Num();
+
+		WriteUInt32(Zip, 0x04034b50);
+		WriteUInt16(Zip, 10);
+		WriteUInt16(Zip, Flags);
+		WriteUInt16(Zip, 0);
+		WriteUInt16(Zip, DosTime);
+		WriteUInt16(Zip, DosDate);
+		WriteUInt32(Zip, Crc);
+		WriteUInt32(Zip, File.Value.Num());
+		WriteUInt32(Zip, File.Value.Num());
+		WriteUInt16(Zip, Name.Length());
+		WriteUInt16(Zip, 0);
+		Zip.Append((const uint8*)Name.Get(), Name.Length());
+		Zip.Append(File.Value);
+
+		WriteUInt32(Directory, 0x02014b50);
+		WriteUInt16(Directory, 20);
+		WriteUInt16(Directory, 10);
+		WriteUInt16(Directory, Flags);
+		WriteUInt16(Directory, 0);
+		WriteUInt16(Directory, DosTime);
+		WriteUInt16(Directory, DosDate);
+		WriteUInt32(Directory, Crc);
+		WriteUInt32(Directory, File.Value.Num());
+		WriteUInt32(Directory, File.Value.Num());
+		WriteUInt16(Directory, Name.Length());
+		WriteUInt16(Directory, 0);
+		WriteUInt16(Directory, 0);
+		WriteUInt16(Directory, 0);
+		WriteUInt16(Directory, 0);
+		WriteUInt32(Directory, 0);
+		WriteUInt32(Directory, Offset);
+		Directory.Append((const uint8*)Name.Get(), Name.Length());
+	}
+
+	const uint32 DirectoryOffset = Zip.Num();
+	Zip.Append(Directory);
+
+	WriteUInt32(Zip, 0x06054b50);
+	WriteUInt16(Zip, 0);
+	WriteUInt16(Zip, 0);
+	WriteUInt16(Zip, Files.Num());
+	WriteUInt16(Zip, Files.Num());
+	WriteUInt32(Zip, Directory.Num());
+	WriteUInt32(Zip, DirectoryOffset);
+	WriteUInt16(Zip, 0);
+
+	return FFileHelper::SaveArrayToFile(Zip, *InPath);
+}
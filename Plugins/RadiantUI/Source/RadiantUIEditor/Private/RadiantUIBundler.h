@@ -0,0 +1,39 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#pragma once
+
+// Cooks a web UI directory under Content into the zip archive the runtime mounts
+// through [RadiantUI] ContentArchives. Each page's consecutive local scripts and
+// stylesheets are minified and concatenated into one file named by its content hash,
+// or inlined into the page when small, and radiantui-manifest.json records the hash
+// of every file so the runtime can serve them as immutable.
+class FRadiantUIBundler
+{
+public:
+
+	// Bundles Content/<InSource>/ into Content/<InSource>.zip. Returns false on failure.
+	static bool Bundle(const FString& InSource);
+
+	// Bundles every [RadiantUI] ContentArchives entry in the game ini. Returns false if
+	// any of them failed.
+	static bool BundleAll();
+
+private:
+
+	FRadiantUIBundler(const FString& InSource);
+
+	bool Run();
+	bool AddSourceFiles();
+	void BundlePage(const FString& InPage);
+	FString AddBundle(const FString& InPage, const FString& InExtension, const FString& InContents);
+	bool WriteArchive(const FString& InPath) const;
+
+	FString Source;
+	FString SourceDir;
+	int32 InlineLimit;
+	TArray<FString> Excludes;
+
+	// archive path to contents, paths are relative to SourceDir with forward slashes.
+	TMap<FString, TArray<uint8>> Files;
+};
@@ -0,0 +1,56 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "RadiantUIEditorPrivatePCH.h"
+#include "ModuleManager.h"
+#include "GameDelegates.h"
+#include "RadiantUIBundler.h"
+
+DEFINE_LOG_CATEGORY(RadiantUIEditorLog);
+
+class FRadiantUIEditorModule : public IModuleInterface
+{
+	virtual void StartupModule() override
+	{
+		// cooking is where packaged content is produced, so the archives are rebuilt
+		// from the loose files every time, the same as any other cooked asset.
+		const bool bCooking = IsRunningCommandlet() && FString(FCommandLine::Get()).Contains(TEXT("-run=cook"), ESearchCase::IgnoreCase);
+
+		if (!bCooking)
+		{
+			return;
+		}
+
+		// the delegate only holds one binding and the game's own takes precedence.
+		FCookModificationDelegate& CookDelegate = FGameDelegates::Get().GetCookModificationDelegate();
+		if (CookDelegate.IsBound())
+		{
+			UE_LOG(RadiantUIEditorLog, Warning, TEXT("The cook modification delegate is already bound, web UI archives won't be rebuilt by this cook. Run -run=RadiantUIBundle before cooking."));
+			return;
+		}
+
+		CookDelegate.BindStatic(&FRadiantUIEditorModule::OnCook);
+		bBoundCookDelegate = true;
+	}
+
+	virtual void ShutdownModule() override
+	{
+		if (bBoundCookDelegate)
+		{
+			FGameDelegates::Get().GetCookModificationDelegate().Unbind();
+			bBoundCookDelegate = false;
+		}
+	}
+
+	static void OnCook(TArray<FString>& ExtraPackagesToCook)
+	{
+		if (!FRadiantUIBundler::BundleAll())
+		{
+			UE_LOG(RadiantUIEditorLog, Error, TEXT("Web UI bundling failed, the packaged game will serve stale or loose content."));
+		}
+	}
+
+	bool bBoundCookDelegate = false;
+};
+
+IMPLEMENT_MODULE(FRadiantUIEditorModule, RadiantUIEditor)
@@ -0,0 +1,7 @@
+// Copyright 2014 Joseph Riedel, All Rights Reserved.
+// See LICENSE for licensing terms.
+
+#include "CoreUObject.h"
+#include "Engine.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(RadiantUIEditorLog, Log, All);
@@ -0,0 +1,27 @@
+// Copyright 2014 Joseph Riedel, Inc. All Rights Reserved.
+
+namespace UnrealBuildTool.Rules
+{
+	public class RadiantUIEditor : ModuleRules
+	{
+		public RadiantUIEditor(ReadOnlyTargetRules Target) : base(Target)
+		{
+			bEnforceIWYU = false;
+
+			PrivateIncludePaths.AddRange(
+				new string[] {
+					"RadiantUIEditor/Private"
+				}
+			);
+
+			PrivateDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"Core",
+					"CoreUObject",
+					"Engine"
+				}
+			);
+		}
+	}
+}